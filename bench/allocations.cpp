@@ -0,0 +1,25 @@
+#include "allocations.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// In a translation unit of their own, so that they are never inlined into
+// the code they count: GCC then mistakes the free of a pointer from the
+// replaced operator new for a mismatched deallocation
+namespace {
+std::atomic<std::size_t> allocations {};
+}
+
+std::size_t allocationCount() { return allocations.load(std::memory_order_relaxed); }
+
+void* operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc {};
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
@@ -0,0 +1,10 @@
+#ifndef ALLOCATIONS_HPP
+#define ALLOCATIONS_HPP
+
+#include <cstddef>
+
+// Calls to the global operator new so far, replaced in allocations.cpp to
+// check that steady state queries stay off the global allocator
+[[nodiscard]] std::size_t allocationCount();
+
+#endif
@@ -0,0 +1,350 @@
+// Compares the solver open lists on a set of maps. Maps ending in .tiles
+// are searched through a TiledGraph with at most -t resident tiles. With
+// -l the other maps are also searched with A* on -l farthest landmarks.
+// The other maps are also searched through an RleGraph, whose memory is
+// reported next to that of the cells of a Graph.
+// With -m the distance matrix between -m points of the other maps is timed
+// against the pairwise queries it replaces. The top left 64x64 corner of
+// each of them is searched through a FixedGraph and a BasicGraph. With -e
+// the legal moves of the other maps are also written as an edge list, read
+// back into a CsrGraph and searched through it.
+// Usage: dijkstra_bench [-q queries] [-t tiles] [-l landmarks] [-m points] [-e] map...
+#include "allocations.hpp"
+#include "csr_graph.hpp"
+#include "dijkstra.hpp"
+#include "distance_matrix.hpp"
+#include "fixed_graph.hpp"
+#include "graph.hpp"
+#include "io.hpp"
+#include "landmarks.hpp"
+#include "open_list.hpp"
+#include "rle_graph.hpp"
+#include "tiled_graph.hpp"
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace {
+
+struct Result {
+    double milliseconds {};
+    std::size_t expansions {};
+    std::size_t reached {};
+    // Calls to the global operator new while timing
+    std::size_t allocations {};
+};
+
+// Rejection sampling over the free cells, with a fixed seed so that every
+// run uses the same queries
+template <typename Id, typename IsFree>
+std::vector<std::pair<Id, Id>> randomQueries(std::size_t cells, IsFree&& isFree, std::size_t count)
+{
+    std::vector<std::pair<Id, Id>> queries {};
+    if (cells == 0)
+        return queries;
+    std::mt19937_64 rng { 42 };
+    std::uniform_int_distribution<std::size_t> pick { 0, cells - 1 };
+    auto freeCell = [&]() -> std::optional<Id> {
+        for (int attempt = 0; attempt < 1000; ++attempt)
+            if (auto const id = static_cast<Id>(pick(rng)); isFree(id))
+                return id;
+        return std::nullopt;
+    };
+    for (std::size_t i = 0; i < count; ++i) {
+        auto const source = freeCell();
+        auto const target = freeCell();
+        if (!source || !target)
+            break;
+        queries.emplace_back(*source, *target);
+    }
+    return queries;
+}
+
+template <typename Solver, typename G>
+Result run(G& graph, std::vector<std::pair<typename G::VertexId, typename G::VertexId>> const& queries, Solver solver = {})
+{
+    Result result {};
+    // Warm up pass, sizes the solver scratch memory for the largest query
+    for (auto const& [source, target] : queries) {
+        solver.loadGraph(graph, source, target);
+        solver.run();
+    }
+
+    auto const allocationsBefore = allocationCount();
+    auto const begin = std::chrono::steady_clock::now();
+    for (auto const& [source, target] : queries) {
+        solver.loadGraph(graph, source, target);
+        solver.run();
+        result.expansions += solver.expansions();
+        result.reached += solver.cost().has_value();
+    }
+    auto const end = std::chrono::steady_clock::now();
+    result.allocations = allocationCount() - allocationsBefore;
+    result.milliseconds = std::chrono::duration<double, std::milli>(end - begin).count();
+    return result;
+}
+
+// Calls to the global operator new made by a new solver for its first query
+template <typename Solver, typename G>
+std::size_t firstAllocations(G& graph, std::pair<typename G::VertexId, typename G::VertexId> const& query)
+{
+    auto const before = allocationCount();
+    Solver solver {};
+    solver.loadGraph(graph, query.first, query.second);
+    solver.run();
+    return allocationCount() - before;
+}
+
+void report(std::string_view name, Result const& result, std::size_t queries)
+{
+    std::cout << "  " << std::left << std::setw(12) << name
+              << std::right << std::fixed << std::setprecision(2)
+              << std::setw(12) << result.milliseconds << " ms"
+              << std::setw(12) << result.milliseconds * 1000. / static_cast<double>(queries) << " us/query"
+              << std::setw(14) << result.expansions << " expansions"
+              << std::setw(8) << result.reached << " reached"
+              << std::setw(8) << result.allocations << " allocations\n";
+}
+
+// The same queries through an RleGraph of the map, whose cells are
+// numbered row * width + col
+template <typename G>
+void runLengths(G const& graph, std::string const& map, std::vector<std::pair<typename G::VertexId, typename G::VertexId>> const& queries)
+{
+    using RleGraph = gr::RleGraph<typename G::ConnectivityType, gr::IntDistance>;
+    RleGraph rle {};
+    rle.fromFile(map);
+    std::vector<std::pair<typename RleGraph::VertexId, typename RleGraph::VertexId>> rleQueries {};
+    auto const rleId = [&](typename G::VertexId id) {
+        auto const& pos = graph.nodes()[static_cast<std::size_t>(id)].pos();
+        return static_cast<typename RleGraph::VertexId>(pos.x.value()) * rle.runs().width() + static_cast<typename RleGraph::VertexId>(pos.y.value());
+    };
+    for (auto const& [source, target] : queries)
+        rleQueries.emplace_back(rleId(source), rleId(target));
+    report("radix/rle", run<BasicDijkstra<RleGraph, RadixHeap<gr::IntDistance, typename RleGraph::VertexId>>>(rle, rleQueries), queries.size());
+    auto const cellBytes = graph.vertexCount() * (sizeof(gr::Vertex) + sizeof(gr::NeighbourMask) + sizeof(gr::Clearance) + sizeof(gr::ComponentId));
+    std::cout << "  " << rle.runs().runCount() << " runs in " << rle.runs().memoryBytes() / 1024 << " KiB, "
+              << cellBytes / 1024 << " KiB for the cells of a Graph\n";
+}
+
+// Queries on the top left Rows x Cols corner of the map, padded with
+// obstacles, through a FixedGraph and a BasicGraph of it. Only the grid of
+// a FixedGraph is inline, the first query of a solver still allocates its
+// state
+template <std::size_t Rows, std::size_t Cols>
+void fixedCorner(std::string const& map, std::size_t count)
+{
+    using FixedGraph = gr::FixedGraph<Rows, Cols, gr::EightConnected>;
+    using SetGraph = gr::BasicGraph<gr::EightConnected>;
+    auto const full = gr::loadMap(map);
+    gr::MapData corner {};
+    for (std::size_t r = 0; r < Rows; ++r) {
+        for (std::size_t c = 0; c < Cols; ++c) {
+            auto type = gr::pointObstacle;
+            if (r < full.rowCount() && c < full.rowStart[r + 1] - full.rowStart[r])
+                type = full.cells[full.rowStart[r] + c] == gr::pointObstacle ? gr::pointObstacle : gr::pointEmpty;
+            corner.cells.push_back(type);
+        }
+        corner.rowStart.push_back(corner.cells.size());
+    }
+    corner.width = Cols;
+    // Too large for the stack
+    static FixedGraph fixed {};
+    fixed.fromMap(corner);
+    SetGraph basic {};
+    basic.fromMap(corner);
+    // Within a component, as a BasicGraph rejects the other queries up front
+    auto qs = randomQueries<typename FixedGraph::VertexId>(
+        FixedGraph::vertexCount(), [&](auto id) { return fixed.type(id) != gr::pointObstacle; }, count);
+    std::erase_if(qs, [&](auto const& q) { return basic.component(q.first) != basic.component(q.second); });
+    std::cout << "  " << Rows << "x" << Cols << " corner, " << qs.size() << " queries\n";
+    if (qs.empty())
+        return;
+
+    std::cout << "  " << firstAllocations<BasicDijkstra<FixedGraph>>(fixed, qs.front()) << " allocations by the first query of a solver on it\n";
+    report("set/fixed", run<BasicDijkstra<FixedGraph>>(fixed, qs), qs.size());
+    report("set/basic", run<BasicDijkstra<SetGraph>>(basic, qs), qs.size());
+}
+
+// The same queries through a CsrGraph read from an edge list of the legal
+// moves of the grid, one per line, whose vertices are the grid's cells
+template <typename G>
+void edgeList(G const& graph, std::vector<std::pair<typename G::VertexId, typename G::VertexId>> const& queries)
+{
+    auto const path = (std::filesystem::temp_directory_path() / "dijkstra_bench.edges").string();
+    {
+        io::File out { path, io::out | io::bin };
+        // Written in batches of lines, like dijkstra_generate does rows
+        constexpr std::size_t batchBytes { std::size_t { 1 } << 20 };
+        std::string batch {};
+        char buffer[32];
+        auto const append = [&](auto value) {
+            auto const [ptr, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+            batch.append(buffer, ec == std::errc {} ? ptr : buffer);
+        };
+        for (std::size_t v = 0; v < graph.vertexCount(); ++v) {
+            graph.forEachNeighbour(static_cast<typename G::VertexId>(v), [&](typename G::VertexId to, typename G::DistanceType d) {
+                append(v);
+                batch += ' ';
+                append(to);
+                batch += ' ';
+                // Shortest form that reads back to the same double
+                append(d.value());
+                batch += '\n';
+            });
+            if (batch.size() >= batchBytes) {
+                out.write(batch);
+                batch.clear();
+            }
+        }
+        out.write(batch);
+    }
+
+    auto const begin = std::chrono::steady_clock::now();
+    gr::CsrGraph csr {};
+    csr.fromEdgeList(path);
+    auto const loaded = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    std::filesystem::remove(path);
+    std::cout << "  " << csr.edgeCount() << " edges read in " << loaded << " ms\n";
+
+    std::vector<std::pair<gr::CsrGraph::VertexId, gr::CsrGraph::VertexId>> csrQueries {};
+    for (auto const& [source, target] : queries)
+        csrQueries.emplace_back(static_cast<gr::CsrGraph::VertexId>(source), static_cast<gr::CsrGraph::VertexId>(target));
+    report("set/csr", run<BasicDijkstra<gr::CsrGraph>>(csr, csrQueries), queries.size());
+
+    BasicDijkstra<G const> grid {};
+    BasicDijkstra<gr::CsrGraph const> edges {};
+    std::size_t mismatches {};
+    for (std::size_t i = 0; i < queries.size(); ++i) {
+        grid.loadGraph(graph, queries[i].first, queries[i].second);
+        grid.run();
+        edges.loadGraph(csr, csrQueries[i].first, csrQueries[i].second);
+        edges.run();
+        mismatches += grid.cost() != edges.cost();
+    }
+    std::cout << "  " << mismatches << " cost mismatches with the grid\n";
+}
+
+template <typename G>
+void matrix(G const& graph, std::size_t count)
+{
+    auto const pairs = randomQueries<typename G::VertexId>(
+        graph.vertexCount(), [&](auto id) { return graph.nodes()[static_cast<std::size_t>(id)].type() != gr::pointObstacle; }, count);
+    std::vector<typename G::VertexId> points {};
+    for (auto const& pair : pairs)
+        points.push_back(pair.first);
+    std::cout << "  " << points.size() << "x" << points.size() << " distance matrix\n";
+
+    auto begin = std::chrono::steady_clock::now();
+    auto const matrix = gr::distanceMatrix(graph, std::span<typename G::VertexId const> { points }, { .threads = 1 });
+    auto const single = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    begin = std::chrono::steady_clock::now();
+    std::ignore = gr::distanceMatrix(graph, std::span<typename G::VertexId const> { points });
+    auto const parallel = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+    BasicDijkstra<G const> solver {};
+    std::size_t mismatches {};
+    begin = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        for (std::size_t j = 0; j < points.size(); ++j) {
+            solver.loadGraph(graph, points[i], points[j]);
+            solver.run();
+            mismatches += solver.cost().value_or(gr::infiniteDistance<typename G::DistanceType>) != matrix.cost(i, j);
+        }
+    }
+    auto const pairwise = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << "  " << std::left << std::setw(12) << "pairwise" << std::right << std::setw(12) << pairwise << " ms\n"
+              << "  " << std::left << std::setw(12) << "matrix" << std::right << std::setw(12) << single << " ms\n"
+              << "  " << std::left << std::setw(12) << "matrix/mt" << std::right << std::setw(12) << parallel << " ms\n"
+              << "  " << mismatches << " mismatches\n";
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t queries { 100 };
+    std::size_t tiles { 64 };
+    std::size_t landmarks {};
+    std::size_t matrixPoints {};
+    bool edges {};
+    std::vector<std::string> maps {};
+    for (int i = 1; i < argc; ++i) {
+        if (std::string_view { argv[i] } == "-q" && i + 1 < argc)
+            queries = std::stoul(argv[++i]);
+        else if (std::string_view { argv[i] } == "-t" && i + 1 < argc)
+            tiles = std::stoul(argv[++i]);
+        else if (std::string_view { argv[i] } == "-l" && i + 1 < argc)
+            landmarks = std::stoul(argv[++i]);
+        else if (std::string_view { argv[i] } == "-m" && i + 1 < argc)
+            matrixPoints = std::stoul(argv[++i]);
+        else if (std::string_view { argv[i] } == "-e")
+            edges = true;
+        else
+            maps.emplace_back(argv[i]);
+    }
+    if (maps.empty())
+        maps.emplace_back("../text_files/example.txt");
+
+    using SetGraph = gr::BasicGraph<gr::EightConnected>;
+    using IntGraph = gr::BasicGraph<gr::EightConnected, gr::IntDistance>;
+    using TiledGraph = gr::TiledGraph<gr::EightConnected, gr::IntDistance>;
+
+    for (auto const& map : maps) {
+        if (map.ends_with(".tiles")) {
+            TiledGraph tiled { map, tiles };
+            auto const qs = randomQueries<TiledGraph::VertexId>(
+                tiled.vertexCount(), [&](auto id) { return tiled.isFree(id); }, queries);
+            std::cout << map << ": " << tiled.vertexCount() << " cells, " << qs.size() << " queries, "
+                      << tiles << " resident tiles at most\n";
+            report("radix/tiled", run<BasicDijkstra<TiledGraph, RadixHeap<gr::IntDistance, TiledGraph::VertexId>>>(tiled, qs), qs.size());
+            std::cout << "  " << tiled.tiles().tileLoads() << " tile loads\n";
+            continue;
+        }
+
+        SetGraph setGraph {};
+        setGraph.fromFile(map);
+        IntGraph intGraph {};
+        intGraph.fromFile(map);
+        auto const qs = randomQueries<gr::Graph::VertexId>(
+            setGraph.vertexCount(), [&](auto id) { return setGraph.nodes()[static_cast<std::size_t>(id)].type() != gr::pointObstacle; }, queries);
+
+        std::cout << map << ": " << setGraph.vertexCount() << " cells, " << qs.size() << " queries\n";
+        report("set", run<BasicDijkstra<SetGraph>>(setGraph, qs), qs.size());
+        report("set/int", run<BasicDijkstra<IntGraph>>(intGraph, qs), qs.size());
+        report("radix/int", run<RadixDijkstra<gr::EightConnected>>(intGraph, qs), qs.size());
+
+        runLengths(setGraph, map, qs);
+        fixedCorner<64, 64>(map, queries);
+        if (edges)
+            edgeList(setGraph, qs);
+        if (matrixPoints != 0)
+            matrix(setGraph, matrixPoints);
+        if (landmarks == 0 || qs.empty())
+            continue;
+
+        auto const begin = std::chrono::steady_clock::now();
+        auto const setTable = gr::LandmarkTable<gr::Distance, SetGraph::VertexId>::farthest(setGraph, qs.front().first, landmarks);
+        auto const intTable = gr::LandmarkTable<gr::IntDistance, IntGraph::VertexId>::farthest(intGraph, qs.front().first, landmarks);
+        auto const end = std::chrono::steady_clock::now();
+        std::cout << "  " << setTable.landmarks().size() << " landmarks, both tables built in "
+                  << std::chrono::duration<double, std::milli>(end - begin).count() << " ms\n";
+        gr::AltDijkstra<SetGraph> alt {};
+        alt.setHeuristic(gr::LandmarkHeuristic { setTable });
+        report("alt", run(setGraph, qs, std::move(alt)), qs.size());
+        gr::AltDijkstra<IntGraph, RadixHeap<gr::IntDistance, IntGraph::VertexId>> altRadix {};
+        altRadix.setHeuristic(gr::LandmarkHeuristic { intTable });
+        report("alt/radix", run(intGraph, qs, std::move(altRadix)), qs.size());
+    }
+}
@@ -1,4 +1,47 @@
 #include "app.hpp"
+#include <algorithm>
+
+std::unique_ptr<App::Session> App::makeSession(gr::ConnectivityMode mode)
+{
+    switch (mode) {
+    case gr::ConnectivityMode::FOUR:
+        return std::make_unique<App::BasicSession<gr::FourConnected>>();
+    case gr::ConnectivityMode::CORNER_CUTTING:
+        return std::make_unique<App::BasicSession<gr::CornerCutting>>();
+    case gr::ConnectivityMode::EIGHT:
+        break;
+    }
+    return std::make_unique<App::BasicSession<gr::EightConnected>>();
+}
+
+void App::LoadAction::poll(sf::Event& event)
+{
+    if (event.type == sf::Event::Closed)
+        app.window.close();
+}
+
+void App::LoadAction::perform(sf::Event& event)
+{
+    (void)event;
+    bool finished {};
+    try {
+        finished = app.loader->poll(app.loaded);
+    } catch (gr::InvalidGraphException const& e) {
+        std::cerr << e.what() << '\n';
+        throw;
+    }
+    gr::MapShape const read { .rows = app.loaded.rowCount(), .cols = app.loaded.width };
+    if (finished) {
+        // The whole map, its exact shape
+        app.fitWindow(read);
+        app.loader.reset();
+        app.loaded = {};
+        app.transition(app.editAction);
+    } else if (read.rows > app.shape.rows || read.cols > app.shape.cols) {
+        // Only grows meanwhile, the guess may still be right
+        app.fitWindow({ .rows = std::max(read.rows, app.shape.rows), .cols = std::max(read.cols, app.shape.cols) });
+    }
+}
 
 void App::EditAction::poll(sf::Event& event)
 {
@@ -6,17 +49,17 @@ void App::EditAction::poll(sf::Event& event)
         app.window.close();
     else if (event.type == sf::Event::KeyPressed
         && event.key.code == sf::Keyboard::Escape) {
-        app.graph.reset();
+        app.session->clear();
     } else if (event.type == sf::Event::KeyPressed
         && event.key.code == sf::Keyboard::Enter) {
-        app.djk.loadGraph(app.graph);
+        app.session->loadGraph();
         app.transition(app.propagateAction);
     }
 }
 
 void App::EditAction::perform(sf::Event& event)
 {
-    updateMouseEventHandler(app.mouseEventHandler, app.settings, event, app.graph);
+    updateMouseEventHandler(app.mouseEventHandler, app.settings, event, app.session->graph());
 }
 
 void App::PropagateAction::poll(sf::Event& event)
@@ -25,7 +68,7 @@ void App::PropagateAction::poll(sf::Event& event)
         app.window.close();
     else if (event.type == sf::Event::KeyPressed
         && event.key.code == sf::Keyboard::Escape) {
-        app.graph.reset();
+        app.session->clear();
         app.transition(app.editAction);
     }
 }
@@ -35,7 +78,7 @@ void App::PropagateAction::perform(sf::Event& event)
     (void)event;
     if (clock.getElapsedTime().asMilliseconds() >= app.settings.timeStep) {
         clock.restart();
-        if (app.djk.done()) {
+        if (app.session->done()) {
             app.transition(app.markAction);
         }
     }
@@ -47,7 +90,7 @@ void App::MarkAction::poll(sf::Event& event)
         app.window.close();
     else if (event.type == sf::Event::KeyPressed
         && event.key.code == sf::Keyboard::Escape) {
-        app.graph.reset();
+        app.session->clear();
         app.transition(app.editAction);
     }
 }
@@ -55,7 +98,7 @@ void App::MarkAction::poll(sf::Event& event)
 void App::MarkAction::perform(sf::Event& event)
 {
     (void)event;
-    app.djk.markShortestPaths();
+    app.session->traceShortestPaths();
     app.transition(app.waitAction);
 }
 
@@ -65,7 +108,7 @@ void App::WaitAction::poll(sf::Event& event)
         app.window.close();
     else if (event.type == sf::Event::KeyPressed
         && event.key.code == sf::Keyboard::Escape) {
-        app.graph.reset();
+        app.session->clear();
         app.transition(app.editAction);
     }
 }
@@ -78,28 +121,64 @@ void App::WaitAction::perform(sf::Event& event)
 App::App(Settings&& settings_, sf::RenderWindow& window_)
     : settings { std::move(settings_) }
     , window { window_ }
+    , session { makeSession(settings.connectivity) }
 {
     if (std::holds_alternative<Grid>(settings.grid)) {
         auto const& [rows, cols] = std::get<Grid>(settings.grid);
-        graph.buildEmpty(rows, cols);
+        session->graph().buildEmpty(rows, cols);
     } else {
-        graph.fromFile(std::get<std::string>(settings.grid));
+        // The graph is built on the loader's thread, the window shows the
+        // rows read meanwhile
+        shape = std::get<MapFile>(settings.grid).shape;
+        loader = std::make_unique<gr::MapLoader>(std::get<MapFile>(settings.grid).path,
+            [&graph = session->graph()](gr::MapData const& map) { graph.fromMap(map); });
+        transition(loadAction);
     }
 }
 
 void App::run()
 {
+    sf::Clock clock {};
+    auto lap = [&] { return static_cast<float>(clock.restart().asMicroseconds()) / 1000.f; };
     while (window.isOpen()) {
+        Hud::Frame frame {};
+        lap();
         sf::Event event;
         while (window.pollEvent(event)) {
-            currentAction->poll(event);
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F1)
+                hud.toggle(window);
+            else
+                currentAction->poll(event);
         }
+        frame.poll = lap();
         currentAction->perform(event);
-        drawGrid(graph, window, settings.cellSize);
+        frame.solve = lap();
+        if (loader)
+            drawMap(loaded, window, settings.cellSize);
+        else
+            drawGrid(session->graph(), *session, window, settings.cellSize);
+        hud.draw(window, settings.windowSize);
         window.display();
+        frame.draw = lap();
+        hud.record(frame, session->expansions(), session->openSize());
     }
 }
 
+void App::fitWindow(gr::MapShape const& cells)
+{
+    shape = cells;
+    // An empty map still needs a window
+    settings.windowSize = {
+        .width = static_cast<int>(std::max<std::size_t>(cells.cols, 1) * settings.cellSize.width),
+        .height = static_cast<int>(std::max<std::size_t>(cells.rows, 1) * settings.cellSize.height)
+    };
+    auto const width = static_cast<unsigned>(settings.windowSize.width);
+    auto const height = static_cast<unsigned>(settings.windowSize.height);
+    window.setSize({ width, height });
+    // Otherwise the old view is stretched over the new size
+    window.setView(sf::View { sf::FloatRect { 0.f, 0.f, static_cast<float>(width), static_cast<float>(height) } });
+}
+
 void App::transition(Action& action)
 {
     currentAction = &action;
@@ -0,0 +1,86 @@
+#include "csr_graph.hpp"
+#include "io.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <system_error>
+
+namespace gr {
+
+namespace {
+    std::string_view skipSpaces(std::string_view s)
+    {
+        auto const first = s.find_first_not_of(" \t\r");
+        return first == std::string_view::npos ? std::string_view {} : s.substr(first);
+    }
+
+    template <typename T>
+    std::string_view parseField(std::string_view s, T& value)
+    {
+        s = skipSpaces(s);
+        auto const [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), value);
+        if (ec != std::errc {})
+            throw InvalidEdgeListException {};
+        return s.substr(static_cast<std::size_t>(ptr - s.data()));
+    }
+}
+
+CsrGraph::CsrGraph(std::size_t vertices, std::span<Edge const> edges)
+{
+    build(vertices, edges);
+}
+
+void CsrGraph::fromEdgeList(std::string_view fname, bool symmetric)
+{
+    io::File f { fname, io::in };
+    std::vector<Edge> edges {};
+    std::size_t vertices {};
+    for (auto line : f) {
+        line = skipSpaces(line);
+        if (line.empty() || line.front() == '#')
+            continue;
+        VertexId from {};
+        VertexId to {};
+        double weight {};
+        line = parseField(line, from);
+        line = parseField(line, to);
+        // from_chars for double is not available everywhere yet
+        std::string const rest { skipSpaces(line) };
+        char* end { nullptr };
+        weight = std::strtod(rest.c_str(), &end);
+        // strtod takes "nan" and "inf", which no search can order
+        if (end == rest.c_str() || !std::isfinite(weight) || weight < 0)
+            throw InvalidEdgeListException {};
+        edges.push_back({ from, to, Distance { weight } });
+        if (symmetric)
+            edges.push_back({ to, from, Distance { weight } });
+        vertices = std::max({ vertices, std::size_t { from } + 1, std::size_t { to } + 1 });
+    }
+    build(vertices, edges);
+}
+
+void CsrGraph::build(std::size_t vertices, std::span<Edge const> edges)
+{
+    // Counting sort of the edges by source vertex
+    offsets.assign(vertices + 1, 0);
+    for (auto const& e : edges) {
+        if (e.from >= vertices || e.to >= vertices)
+            throw InvalidEdgeListException {};
+        offsets[e.from + 1] += 1;
+    }
+    for (std::size_t v = 0; v < vertices; ++v)
+        offsets[v + 1] += offsets[v];
+
+    targets.resize(edges.size());
+    weights.resize(edges.size());
+    auto next = offsets;
+    for (auto const& e : edges) {
+        auto const slot = next[e.from]++;
+        targets[slot] = e.to;
+        weights[slot] = e.weight;
+    }
+}
+
+}
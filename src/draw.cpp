@@ -1,18 +1,15 @@
-#ifndef DRAW_HPP
-#define DRAW_HPP
-
 #include "draw.hpp"
 #include "SFML/Graphics.hpp"
 #include "colors.hpp"
 #include "graph.hpp"
 #include "settings.hpp"
 #include <algorithm>
-#include <ranges>
+#include <cstddef>
 #include <vector>
 
 namespace {
 
-sf::RectangleShape& getRectangle(gr::Vertex const& v, CellSize const& cellSize)
+sf::RectangleShape& getRectangle(gr::Position const& pos, CellSize const& cellSize)
 {
     constexpr static unsigned border { 2 };
 
@@ -20,49 +17,68 @@ sf::RectangleShape& getRectangle(gr::Vertex const& v, CellSize const& cellSize)
     rectangle.setOutlineThickness(1.f);
     rectangle.setOutlineColor(sf::Color(150, 150, 150));
     rectangle.setPosition(sf::Vector2f {
-        static_cast<float>(v.pos().y.value() * cellSize.width + border / 2),
-        static_cast<float>(v.pos().x.value() * cellSize.height + border / 2) });
+        static_cast<float>(pos.y.value() * cellSize.width + border / 2),
+        static_cast<float>(pos.x.value() * cellSize.height + border / 2) });
     return rectangle;
 }
 
-void drawCell(gr::Vertex const& v, sf::RenderWindow& window, CellSize const& cellSize, gr::Distance maxDistance)
+// Of the types a map file holds
+sf::Color mapColor(gr::CharType type)
 {
-    auto& rectangle = getRectangle(v, cellSize);
+    switch (type) {
+    case gr::pointObstacle:
+        return obstacleColor;
+    case gr::pointStart:
+        return startColor;
+    case gr::pointEnd:
+        return endColor;
+    }
+    return emptyColor;
+}
+
+void drawCell(SearchView const& view, gr::Vertex const& v, sf::RenderWindow& window, CellSize const& cellSize, gr::Distance maxDistance)
+{
+    auto& rectangle = getRectangle(v.pos(), cellSize);
 
-    switch (v.type()) {
+    auto const type = view.shownType(v);
+    switch (type) {
     case gr::pointEmpty:
-        rectangle.setFillColor(emptyColor);
-        break;
     case gr::pointObstacle:
-        rectangle.setFillColor(obstacleColor);
+    case gr::pointStart:
+    case gr::pointEnd:
+        rectangle.setFillColor(mapColor(type));
         break;
     case gr::pointBifurcation:
     case gr::pointShortest:
         rectangle.setFillColor(shortestColor);
         break;
     case gr::pointVisited:
-        rectangle.setFillColor(colorFromGradient(v.dist().value(), maxDistance.value()));
+        rectangle.setFillColor(colorFromGradient(view.shownDistance(v).value(), maxDistance.value()));
         break;
     case gr::pointFront:
         rectangle.setFillColor(frontColor);
         break;
-    case gr::pointStart:
-        rectangle.setFillColor(startColor);
-        break;
-    case gr::pointEnd:
-        rectangle.setFillColor(endColor);
-        break;
     }
     window.draw(rectangle);
 }
 
 }
 
-void drawGrid(gr::Graph const& graph, sf::RenderWindow& window, CellSize const& cellSize)
+void drawGrid(gr::Graph const& graph, SearchView const& view, sf::RenderWindow& window, CellSize const& cellSize)
 {
-    std::ranges::for_each(graph.nodes() | std::ranges::views::join, [&](auto const& node) {
-        drawCell(node, window, cellSize, graph.getMaxDistance());
+    auto const maxDistance = view.maxDistance();
+    std::ranges::for_each(graph.nodes(), [&](auto const& node) {
+        drawCell(view, node, window, cellSize, maxDistance);
     });
 }
 
-#endif
\ No newline at end of file
+void drawMap(gr::MapData const& map, sf::RenderWindow& window, CellSize const& cellSize)
+{
+    for (std::size_t r = 0; r < map.rowCount(); ++r) {
+        for (auto i = map.rowStart[r]; i < map.rowStart[r + 1]; ++i) {
+            auto& rectangle = getRectangle({ gr::X { static_cast<int>(r) }, gr::Y { static_cast<int>(i - map.rowStart[r]) } }, cellSize);
+            rectangle.setFillColor(mapColor(map.cells[i]));
+            window.draw(rectangle);
+        }
+    }
+}
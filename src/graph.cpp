@@ -1,21 +1,26 @@
 #include "graph.hpp"
 #include "io.hpp"
+#include "map_parser.hpp"
 #include "optional_pointer.hpp"
 #include <algorithm>
 #include <array>
+#include <bit>
 #include <cmath>
 #include <compare>
+#include <filesystem>
 #include <functional>
 #include <iterator>
+#include <numeric>
 #include <ostream>
 #include <ranges>
-#include <sstream>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 namespace gr {
+
 Position operator+(Position const& a, Position const& b)
 {
     return { { a.x + b.x }, { a.y + b.y } };
@@ -39,16 +44,6 @@ Vertex::Vertex(UniqueIdType id, CharType type_, Position const& p)
     , mType { type_ }
     , mPos { p }
 {
-    switch (mType) {
-    case pointEmpty:
-    case pointEnd:
-    case pointObstacle:
-        setDist(infinite);
-        break;
-    case pointStart:
-        setDist(Distance { 0.f });
-        break;
-    }
 }
 
 CharType Vertex::type() const { return mType; }
@@ -57,196 +52,449 @@ bool Vertex::isStart() const { return type() == pointStart; }
 
 bool Vertex::isEnd() const { return type() == pointEnd; }
 
-bool Vertex::isShortest() const
-{
-    return type() == pointShortest || type() == pointBifurcation;
-}
-
-bool Vertex::isValid(Vertex const& v, Graph& graph) const
-{
-    if (type() == pointObstacle)
-        return false;
-
-    if (auto const diff = v.pos() - pos(); diff.x.value() == 0 || diff.y.value() == 0)
-        return true;
-
-    auto const minXVertex = std::min(v, *this, [](Vertex const& a, Vertex const& b) {
-        return a.pos().x < b.pos().x;
-    });
-    auto const minYVertex = std::min(v, *this, [](Vertex const& a, Vertex const& b) {
-        return a.pos().y < b.pos().y;
-    });
-
-    auto const validDiagonal = [](OptionalPointer<Vertex> const& a, OptionalPointer<Vertex> const& b) {
-        return a && b && a->type() != pointObstacle && b->type() != pointObstacle;
-    };
-
-    if (minXVertex == minYVertex) {
-        OptionalPointer<Vertex> const a = graph.vertexPtr(minXVertex.pos() + Position { X { 1 }, Y { 0 } });
-        OptionalPointer<Vertex> const b = graph.vertexPtr(minXVertex.pos() + Position { X { 0 }, Y { 1 } });
-        return validDiagonal(a, b);
-    }
-
-    OptionalPointer<Vertex> const a = graph.vertexPtr(minXVertex.pos() + Position { X { 0 }, Y { -1 } });
-    OptionalPointer<Vertex> const b = graph.vertexPtr(minXVertex.pos() + Position { X { 1 }, Y { 0 } });
-    return validDiagonal(a, b);
-}
-
-Distance const& Vertex::dist() const { return mDist; }
-
-bool Vertex::distIsInfinite() const { return dist() == infinite; }
-
-void Vertex::setDist(Distance const& d) { mDist = d; }
-
 void Vertex::setType(CharType t) { mType = t; }
 
 Vertex::UniqueIdType Vertex::id() const { return uniqueId; }
 
 Position const& Vertex::pos() const { return mPos; }
 
-void Vertex::reset()
+MapData loadMap(std::string_view fname)
 {
-    if (type() != pointStart && type() != pointEnd) {
-        setDist(infinite);
-        setType(pointEmpty);
-    }
+    // In one read, the parser wants the whole text at once. Opened first so
+    // that a missing file throws a FileException
+    io::File file { fname, io::in | io::bin };
+    std::string text(static_cast<std::size_t>(std::filesystem::file_size(fname)), '\0');
+    file.read(text.data(), text.size());
+    return parseMap(text);
 }
 
 void Graph::fromFile(std::string_view fname)
 {
-    io::File f { fname, io::in };
-    VertexType::UniqueIdType elementCount { 0 };
-    bool foundStart { false };
-    bool foundEnd { false };
-    auto lineCount { 0 };
-    for (auto line : f) {
-        auto colCount { 0 };
-        std::vector<Vertex> v;
-        v.reserve(line.size());
-        for (auto c : line) {
-            switch (static_cast<CharType>(c)) {
-            case pointStart:
-                if (foundStart)
-                    throw InvalidGraphException {};
-                foundStart = true;
-                break;
-            case pointEnd:
-                if (foundEnd)
-                    throw InvalidGraphException {};
-                foundEnd = true;
-                break;
-            case pointEmpty:
-            case pointObstacle:
-                // Ok valid entries
-                break;
-            default:
-                throw InvalidGraphException {};
-                break;
-            }
-            v.emplace_back(elementCount, static_cast<CharType>(c), Position { X { lineCount }, Y { colCount } });
-            colCount += 1;
-            elementCount += 1;
+    fromMap(loadMap(fname));
+}
+
+void Graph::fromMap(MapData const& map)
+{
+    cells.clear();
+    cells.reserve(map.cells.size());
+    rowStart = map.rowStart;
+    for (std::size_t r = 0; r < map.rowCount(); ++r) {
+        for (auto i = map.rowStart[r]; i < map.rowStart[r + 1]; ++i) {
+            cells.emplace_back(static_cast<VertexId>(i), map.cells[i],
+                Position { X { static_cast<int>(r) }, Y { static_cast<int>(i - map.rowStart[r]) } });
         }
-        vertex.push_back(std::move(v));
-        lineCount += 1;
     }
+    start = map.start ? std::optional<VertexId> { static_cast<VertexId>(*map.start) } : std::nullopt;
+    ends.assign(map.ends.begin(), map.ends.end());
+    mapVersion += 1;
+    computeMoves();
+    computeClearance();
+    computeComponents();
 }
 
 void Graph::buildEmpty(unsigned sizeX, unsigned sizeY)
 {
-    vertex.resize(sizeX);
-    int row {}, counter {};
-    for (auto& line : vertex) {
-        int col {};
-        line.reserve(sizeY);
-        for (unsigned i = 0; i < sizeY; ++i) {
-            line.emplace_back(counter, pointEmpty, Position { X { row }, Y { col } });
+    cells.clear();
+    rowStart.assign(1, 0);
+    cells.reserve(static_cast<std::size_t>(sizeX) * sizeY);
+    int counter {};
+    for (unsigned row = 0; row < sizeX; ++row) {
+        for (unsigned col = 0; col < sizeY; ++col) {
+            cells.emplace_back(counter, pointEmpty, Position { X { static_cast<int>(row) }, Y { static_cast<int>(col) } });
             counter += 1;
-            col += 1;
         }
-        row += 1;
+        rowStart.push_back(cells.size());
     }
-    vertex[0][0].setType(pointStart);
-    vertex[0][0].setDist(Distance { 0 });
-    vertex[0][1].setType(pointEnd);
+    cells[0].setType(pointStart);
+    cells[1].setType(pointEnd);
+    start = cells[0].id();
+    ends.assign(1, cells[1].id());
+    mapVersion += 1;
+    computeMoves();
+    computeClearance();
+    computeComponents();
 }
 
 OptionalPointer<Graph::VertexType> Graph::vertexPtr(Position const& mPos)
 {
     if (mPos.x.value() >= 0
         && mPos.y.value() >= 0
-        && mPos.x.value() < static_cast<decltype(mPos.x.value())>(vertex.size())
-        && mPos.y.value() < static_cast<decltype(mPos.y.value())>(vertex[mPos.x.value()].size()))
-        return { &vertex[mPos.x.value()][mPos.y.value()] };
+        && mPos.x.value() < static_cast<int>(rowCount())
+        && mPos.y.value() < static_cast<int>(row(static_cast<std::size_t>(mPos.x.value())).size()))
+        return { &cells[rowStart[static_cast<std::size_t>(mPos.x.value())] + static_cast<std::size_t>(mPos.y.value())] };
     return std::nullopt;
 }
 
-std::vector<std::reference_wrapper<Graph::VertexType>> Graph::neighborhoods(Graph::VertexType const& v)
+NeighbourMask Graph::moves(Graph::VertexType const& v) const
 {
-    constexpr static std::array coords {
-        Position { X { -1 }, Y { -1 } },
-        Position { X { 0 }, Y { -1 } },
-        Position { X { 1 }, Y { -1 } },
-        Position { X { -1 }, Y { 0 } },
-        Position { X { 1 }, Y { 0 } },
-        Position { X { -1 }, Y { 1 } },
-        Position { X { 0 }, Y { 1 } },
-        Position { X { 1 }, Y { 1 } }
-    };
+    return moveMask[static_cast<std::size_t>(v.id())];
+}
 
-    auto view = std::ranges::views::transform(coords, [&](Position const& pos) {
-        return vertexPtr({ v.pos() - pos });
-    }) | std::ranges::views::filter([&](OptionalPointer<Graph::VertexType> ptr) {
-        return ptr && ptr->isValid(v, *this);
-    }) | std::ranges::views::transform([](OptionalPointer<Graph::VertexType> ptr) {
-        return std::ref(*ptr);
-    });
+bool Graph::isFree(Position const& pos) const
+{
+    if (pos.x.value() < 0
+        || pos.y.value() < 0
+        || pos.x.value() >= static_cast<int>(rowCount()))
+        return false;
+    auto const line = row(static_cast<std::size_t>(pos.x.value()));
+    return pos.y.value() < static_cast<int>(line.size())
+        && line[static_cast<std::size_t>(pos.y.value())].type() != pointObstacle;
+}
 
-    return { std::begin(view), std::end(view) };
+template <Connectivity C, typename D>
+void BasicGraph<C, D>::computeMoves()
+{
+    // Obstacles and out of range cells are flattened once in a padded byte grid,
+    // so that the per cell work is a handful of loads without bounds checks.
+    std::size_t width {};
+    for (std::size_t r = 0; r < rowCount(); ++r)
+        width = std::max(width, row(r).size());
+    std::size_t const stride = width + 2;
+    std::vector<unsigned char> free((rowCount() + 2) * stride, 0);
+    for (std::size_t r = 0; r < rowCount(); ++r) {
+        auto const line = row(r);
+        for (std::size_t col = 0; col < line.size(); ++col)
+            free[(r + 1) * stride + col + 1] = line[col].type() != pointObstacle;
+    }
+
+    moveMask.assign(cells.size(), 0);
+    for (std::size_t r = 0; r < rowCount(); ++r) {
+        for (std::size_t col = 0; col < row(r).size(); ++col) {
+            auto const centre = (r + 1) * stride + col + 1;
+            moveMask[rowStart[r] + col] = movesFrom<C>([&](int dx, int dy) {
+                return free[static_cast<std::size_t>(static_cast<std::ptrdiff_t>(centre) + dx * static_cast<std::ptrdiff_t>(stride) + dy)] != 0;
+            });
+        }
+    }
 }
 
-std::vector<std::vector<Graph::VertexType>>& Graph::nodes() { return vertex; }
-std::vector<std::vector<Graph::VertexType>> const& Graph::nodes() const { return vertex; }
+template <Connectivity C, typename D>
+void BasicGraph<C, D>::updateMoves(Position const& pos)
+{
+    // Only the 3x3 block around a toggled cell can see its legality change
+    for (int dx = -1; dx <= 1; ++dx) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            auto ptr = vertexPtr(pos + Position { X { dx }, Y { dy } });
+            if (!ptr)
+                continue;
+            moveMask[static_cast<std::size_t>(ptr->id())] = movesFrom<C>([&](int ox, int oy) {
+                return isFree(ptr->pos() + Position { X { ox }, Y { oy } });
+            });
+        }
+    }
+}
+
+std::vector<Graph::VertexType>& Graph::nodes() { return cells; }
+std::vector<Graph::VertexType> const& Graph::nodes() const { return cells; }
+
+std::span<Graph::VertexType const> Graph::row(std::size_t r) const
+{
+    return { cells.data() + rowStart[r], rowStart[r + 1] - rowStart[r] };
+}
+
+std::size_t Graph::rowCount() const { return rowStart.size() - 1; }
 
 void Graph::markAs(Graph::VertexType const& v, CharType pointType)
 {
-    auto pos = v.pos();
-    vertex[pos.x.value()][pos.y.value()].setType(pointType);
+    markAs(v.id(), pointType);
 }
 
-std::string Graph::stringify() const
+void Graph::markAs(VertexId id, CharType pointType)
 {
-    std::string s {};
-    for (auto const& line : vertex) {
-        for (auto const& v : line) {
-            std::ostringstream ss {};
-            ss << v;
-            s += ss.str();
+    switch (pointType) {
+    case pointEmpty:
+    case pointObstacle:
+    case pointStart:
+    case pointEnd:
+        break;
+    default:
+        throw InvalidGraphException {};
+    }
+
+    mapVersion += 1;
+    auto& target = cells[static_cast<std::size_t>(id)];
+    bool const wasObstacle = target.type() == pointObstacle;
+    if (start == id)
+        start = std::nullopt;
+    std::erase(ends, id);
+    target.setType(pointType);
+    if (pointType == pointStart) {
+        // Free before and after, so the moves stay the same
+        if (start)
+            cells[static_cast<std::size_t>(*start)].setType(pointEmpty);
+        start = id;
+    } else if (pointType == pointEnd) {
+        ends.push_back(id);
+    }
+    if (wasObstacle != (pointType == pointObstacle)) {
+        updateMoves(target.pos());
+        updateClearance(target.pos());
+        updateComponents(target.pos(), wasObstacle);
+    }
+}
+
+void Graph::computeClearance()
+{
+    std::size_t width {};
+    for (std::size_t r = 0; r < rowCount(); ++r)
+        width = std::max(width, row(r).size());
+    auto const grid = gr::computeClearance(rowCount(), width, [&](std::size_t r, std::size_t col) {
+        return col < row(r).size() && row(r)[col].type() != pointObstacle;
+    });
+    clearances.resize(cells.size());
+    for (std::size_t r = 0; r < rowCount(); ++r)
+        std::copy_n(grid.begin() + static_cast<std::ptrdiff_t>(r * width), row(r).size(), clearances.begin() + static_cast<std::ptrdiff_t>(rowStart[r]));
+}
+
+void Graph::updateClearance(Position const& pos)
+{
+    auto const at = [&](std::int64_t r, std::int64_t col) { return clearanceAt(r, col); };
+    auto const r = static_cast<std::int64_t>(pos.x.value());
+    auto const col = static_cast<std::int64_t>(pos.y.value());
+    auto const reach = clearanceReach(r, col, at);
+    auto const firstRow = std::max<std::int64_t>(r - reach, 0);
+    auto const lastRow = std::min<std::int64_t>(r + reach + 1, static_cast<std::int64_t>(rowCount()));
+    refillClearance(firstRow, lastRow, col - reach, col + reach + 1,
+        [&](std::int64_t row_, std::int64_t col_) { return isFree(Position { X { static_cast<int>(row_) }, Y { static_cast<int>(col_) } }); },
+        at,
+        [&](std::int64_t row_, std::int64_t col_, Clearance c) {
+            if (col_ >= 0 && static_cast<std::size_t>(col_) < row(static_cast<std::size_t>(row_)).size())
+                clearances[rowStart[static_cast<std::size_t>(row_)] + static_cast<std::size_t>(col_)] = c;
+        });
+}
+
+Clearance Graph::clearanceAt(std::int64_t r, std::int64_t col) const
+{
+    if (r < 0 || col < 0 || static_cast<std::size_t>(r) >= rowCount()
+        || static_cast<std::size_t>(col) >= row(static_cast<std::size_t>(r)).size())
+        return 0;
+    return clearances[rowStart[static_cast<std::size_t>(r)] + static_cast<std::size_t>(col)];
+}
+
+template <typename F>
+void Graph::forEachMove(VertexId id, F&& f) const
+{
+    auto const& pos = cells[static_cast<std::size_t>(id)].pos();
+    auto const mask = moveMask[static_cast<std::size_t>(id)];
+    auto const moves = moveList();
+    for (std::size_t i = 0; i < moves.size(); ++i) {
+        if (mask & (1u << i))
+            f(idAt(pos.x.value() + moves[i].dx, pos.y.value() + moves[i].dy));
+    }
+}
+
+void Graph::computeComponents()
+{
+    components = labelComponents(
+        rowStart,
+        [&](std::size_t v) { return cells[v].type() != pointObstacle; },
+        [&](std::size_t v, auto&& f) { forEachMove(static_cast<VertexId>(v), [&](VertexId n) { f(static_cast<std::size_t>(n)); }); });
+    componentSizes.clear();
+    spareComponents.clear();
+    for (auto c : components) {
+        if (c == noComponent)
+            continue;
+        if (c == componentSizes.size())
+            componentSizes.push_back(0);
+        componentSizes[c] += 1;
+    }
+}
+
+void Graph::updateComponents(Position const& pos, bool freed)
+{
+    // Toggling a cell only adds or removes moves from it and diagonals past
+    // it, all of them between the cells around it. Those are grouped by the
+    // moves that join them within the 3x3 block
+    auto const centre = idAt(pos.x.value(), pos.y.value());
+    auto const old = components[static_cast<std::size_t>(centre)];
+    std::vector<VertexId> around {};
+    for (int dx = -1; dx <= 1; ++dx) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            auto const p = pos + Position { X { dx }, Y { dy } };
+            if (isFree(p) && (freed || components[static_cast<std::size_t>(idAt(p.x.value(), p.y.value()))] == old))
+                around.push_back(idAt(p.x.value(), p.y.value()));
+        }
+    }
+    std::vector<std::size_t> group(around.size());
+    std::iota(group.begin(), group.end(), std::size_t { 0 });
+    auto const groupOf = [&](std::size_t i) {
+        while (group[i] != i)
+            i = group[i];
+        return i;
+    };
+    for (std::size_t i = 0; i < around.size(); ++i) {
+        forEachMove(around[i], [&](VertexId n) {
+            if (auto const j = std::ranges::find(around, n) - around.begin(); static_cast<std::size_t>(j) < around.size())
+                group[std::max(groupOf(i), groupOf(static_cast<std::size_t>(j)))] = std::min(groupOf(i), groupOf(static_cast<std::size_t>(j)));
+        });
+    }
+
+    if (freed) {
+        // Each group joins the components of its cells into the largest one
+        for (std::size_t g = 0; g < around.size(); ++g) {
+            if (groupOf(g) != g)
+                continue;
+            auto kept = noComponent;
+            for (std::size_t i = 0; i < around.size(); ++i) {
+                auto const c = components[static_cast<std::size_t>(around[i])];
+                if (groupOf(i) == g && c != noComponent && (kept == noComponent || componentSizes[kept] < componentSizes[c]))
+                    kept = c;
+            }
+            if (kept == noComponent)
+                kept = newComponent();
+            for (std::size_t i = 0; i < around.size(); ++i) {
+                auto const c = components[static_cast<std::size_t>(around[i])];
+                if (groupOf(i) != g || c == kept)
+                    continue;
+                if (c != noComponent) {
+                    componentSizes[kept] += componentSizes[c];
+                    componentSizes[c] = 0;
+                    spareComponents.push_back(c);
+                    relabel(around[i], c, kept);
+                } else {
+                    components[static_cast<std::size_t>(around[i])] = kept;
+                    componentSizes[kept] += 1;
+                }
+            }
+        }
+        return;
+    }
+
+    components[static_cast<std::size_t>(centre)] = noComponent;
+    componentSizes[old] -= 1;
+    if (componentSizes[old] == 0)
+        spareComponents.push_back(old);
+    std::vector<std::size_t> roots {};
+    for (std::size_t g = 0; g < around.size(); ++g) {
+        if (groupOf(g) == g)
+            roots.push_back(g);
+    }
+    if (roots.size() <= 1)
+        return;
+
+    // The groups may have been cut apart. They are searched from in turns,
+    // one cell each, and merge when they meet. A group whose search runs dry
+    // before the others is a component of its own; the last one left keeps
+    // the label, so the work is bounded by the pieces that get relabelled
+    std::unordered_map<VertexId, std::size_t> owner {};
+    std::vector<std::vector<VertexId>> seen(roots.size());
+    std::vector<std::size_t> next(roots.size());
+    std::vector<std::size_t> joined(roots.size());
+    std::vector<bool> finished(roots.size());
+    std::iota(joined.begin(), joined.end(), std::size_t { 0 });
+    auto const joinedOf = [&](std::size_t s) {
+        while (joined[s] != s)
+            s = joined[s];
+        return s;
+    };
+    for (std::size_t s = 0; s < roots.size(); ++s) {
+        for (std::size_t i = 0; i < around.size(); ++i) {
+            if (groupOf(i) == roots[s]) {
+                owner.emplace(around[i], s);
+                seen[s].push_back(around[i]);
+            }
+        }
+    }
+    auto searching = roots.size();
+    while (searching > 1) {
+        for (std::size_t s = 0; s < roots.size(); ++s) {
+            if (finished[joinedOf(s)] || next[s] == seen[s].size())
+                continue;
+            forEachMove(seen[s][next[s]++], [&](VertexId n) {
+                auto const [it, added] = owner.emplace(n, s);
+                if (added) {
+                    seen[s].push_back(n);
+                } else if (auto const a = joinedOf(s), b = joinedOf(it->second); a != b) {
+                    joined[std::max(a, b)] = std::min(a, b);
+                    searching -= 1;
+                }
+            });
+        }
+        for (std::size_t s = 0; s < roots.size() && searching > 1; ++s) {
+            if (joinedOf(s) != s || finished[s])
+                continue;
+            bool dry { true };
+            for (std::size_t t = 0; t < roots.size(); ++t)
+                dry = dry && (joinedOf(t) != s || next[t] == seen[t].size());
+            if (!dry)
+                continue;
+            finished[s] = true;
+            searching -= 1;
+            auto const label = newComponent();
+            for (std::size_t t = 0; t < roots.size(); ++t) {
+                if (joinedOf(t) != s)
+                    continue;
+                for (auto v : seen[t])
+                    components[static_cast<std::size_t>(v)] = label;
+                componentSizes[label] += seen[t].size();
+                componentSizes[old] -= seen[t].size();
+            }
         }
-        s += '\n';
     }
-    return s;
 }
 
-void Graph::reset()
+void Graph::relabel(VertexId v, ComponentId from, ComponentId to)
 {
-    std::ranges::for_each(vertex | std::ranges::views::join, [](auto& item) { item.reset(); });
-    maxDistance = Distance { 0 };
+    std::vector<VertexId> stack { v };
+    components[static_cast<std::size_t>(v)] = to;
+    while (!stack.empty()) {
+        auto const current = stack.back();
+        stack.pop_back();
+        forEachMove(current, [&](VertexId n) {
+            if (components[static_cast<std::size_t>(n)] == from) {
+                components[static_cast<std::size_t>(n)] = to;
+                stack.push_back(n);
+            }
+        });
+    }
 }
 
-void Graph::updateMaxDistance(Distance newDisatnce)
+ComponentId Graph::newComponent()
 {
-    if (newDisatnce > maxDistance)
-        maxDistance = newDisatnce;
+    if (spareComponents.empty()) {
+        componentSizes.push_back(0);
+        return static_cast<ComponentId>(componentSizes.size() - 1);
+    }
+    auto const label = spareComponents.back();
+    spareComponents.pop_back();
+    return label;
 }
-Distance Graph::getMaxDistance() const
+
+std::string Graph::stringify() const
+{
+    std::string s(serializedSize(), '\0');
+    serialize(s, [](std::string_view) { });
+    return s;
+}
+
+std::size_t Graph::serializedSize() const { return cells.size() + rowCount(); }
+
+void Graph::serialize(std::span<char> buffer, std::function<void(std::string_view)> const& out) const
 {
-    return maxDistance;
+    std::size_t used {};
+    auto put = [&](char c) {
+        if (used == buffer.size()) {
+            out({ buffer.data(), used });
+            used = 0;
+        }
+        buffer[used++] = c;
+    };
+    for (std::size_t r = 0; r < rowCount(); ++r) {
+        for (auto const& v : row(r))
+            put(static_cast<char>(v.type()));
+        put('\n');
+    }
+    if (used != 0)
+        out({ buffer.data(), used });
 }
 
 std::ostream& operator<<(std::ostream& os, Graph const& lvl)
 {
-    return os << lvl.stringify();
+    std::array<char, 4096> buffer;
+    lvl.serialize(buffer, [&](std::string_view piece) {
+        os.write(piece.data(), static_cast<std::streamsize>(piece.size()));
+    });
+    return os;
 }
 
 std::ostream& operator<<(std::ostream& os, Graph::VertexType const& v)
@@ -254,8 +502,23 @@ std::ostream& operator<<(std::ostream& os, Graph::VertexType const& v)
     return os << v.type();
 }
 
-void writeGraph(std::string_view fname, Graph const& graph)
+void writeGraph(std::string_view fname, Graph const& graph, WriteMode mode)
 {
-    io::File { fname, io::out }.write(graph.stringify().c_str());
+    if (mode == WriteMode::MAPPED && io::mappedFilesAvailable) {
+        // Written in place, the mapping is exactly the size of the output
+        io::MappedFile file { fname, graph.serializedSize() };
+        graph.serialize(file.data(), [](std::string_view) { });
+        return;
+    }
+    io::File file { fname, io::out | io::bin };
+    std::vector<char> buffer(std::size_t { 1 } << 16);
+    graph.serialize(buffer, [&](std::string_view piece) { file.write(piece); });
 }
+
+template class BasicGraph<FourConnected>;
+template class BasicGraph<EightConnected>;
+template class BasicGraph<CornerCutting>;
+template class BasicGraph<FourConnected, IntDistance>;
+template class BasicGraph<EightConnected, IntDistance>;
+template class BasicGraph<CornerCutting, IntDistance>;
 }
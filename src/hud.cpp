@@ -0,0 +1,94 @@
+#include "hud.hpp"
+#include "colors.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+
+namespace {
+
+// Scale of the bars, and the height they are clipped to
+constexpr float pixelsPerMs { 4.f };
+constexpr float maxBar { 100.f };
+constexpr float barWidth { 3.f };
+// One frame at 60 Hz
+constexpr float frameBudget { 1000.f / 60.f };
+// How often the title is refreshed, setting it every frame is not free
+constexpr float titlePeriod { 0.5f };
+
+}
+
+Hud::Hud(std::string title_)
+    : title { std::move(title_) }
+{
+}
+
+void Hud::toggle(sf::RenderWindow& window)
+{
+    shown = !shown;
+    if (!shown)
+        window.setTitle(title);
+}
+
+void Hud::record(Frame const& frame, std::size_t expansions, std::size_t open)
+{
+    history[next] = frame;
+    next = (next + 1) % historySize;
+    // A new search starts again from zero
+    newExpansions += expansions >= lastExpansions ? expansions - lastExpansions : expansions;
+    lastExpansions = expansions;
+    openSize = open;
+}
+
+void Hud::updateTitle(sf::RenderWindow& window)
+{
+    auto const elapsed = titleClock.getElapsedTime().asSeconds();
+    if (elapsed < titlePeriod)
+        return;
+    Frame mean {};
+    for (auto const& f : history) {
+        mean.poll += f.poll / historySize;
+        mean.solve += f.solve / historySize;
+        mean.draw += f.draw / historySize;
+    }
+    char text[160];
+    std::snprintf(text, sizeof(text), "%s | frame %.2f ms (poll %.2f, solve %.2f, draw %.2f) | %.0f expansions/s | open %zu",
+        title.c_str(), static_cast<double>(mean.poll + mean.solve + mean.draw),
+        static_cast<double>(mean.poll), static_cast<double>(mean.solve), static_cast<double>(mean.draw),
+        static_cast<double>(newExpansions) / static_cast<double>(elapsed), openSize);
+    window.setTitle(text);
+    newExpansions = 0;
+    titleClock.restart();
+}
+
+void Hud::draw(sf::RenderWindow& window, WindowSize const& size)
+{
+    if (!shown)
+        return;
+    updateTitle(window);
+
+    auto const bottom = static_cast<float>(size.height);
+    sf::RectangleShape background { sf::Vector2f { barWidth * historySize, maxBar } };
+    background.setFillColor(hudBackgroundColor);
+    background.setPosition({ 0.f, bottom - maxBar });
+    window.draw(background);
+
+    sf::RectangleShape bar {};
+    // Oldest frame on the left
+    for (std::size_t i = 0; i < historySize; ++i) {
+        auto const& f = history[(next + i) % historySize];
+        float y { bottom };
+        for (auto const& [ms, color] : { std::pair { f.poll, hudPollColor }, std::pair { f.solve, hudSolveColor }, std::pair { f.draw, hudDrawColor } }) {
+            auto const height = std::min(ms * pixelsPerMs, y - (bottom - maxBar));
+            y -= height;
+            bar.setSize({ barWidth, height });
+            bar.setPosition({ barWidth * static_cast<float>(i), y });
+            bar.setFillColor(color);
+            window.draw(bar);
+        }
+    }
+
+    sf::RectangleShape budget { sf::Vector2f { barWidth * historySize, 1.f } };
+    budget.setFillColor(hudBudgetColor);
+    budget.setPosition({ 0.f, bottom - std::min(frameBudget * pixelsPerMs, maxBar) });
+    window.draw(budget);
+}
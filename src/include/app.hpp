@@ -4,9 +4,13 @@
 #include "dijkstra.hpp"
 #include "draw.hpp"
 #include "graph.hpp"
+#include "hud.hpp"
+#include "map_loader.hpp"
 #include "mouse_event_handler.hpp"
 #include "settings.hpp"
 #include <iostream>
+#include <memory>
+#include <optional>
 #include <utility>
 
 class App {
@@ -17,6 +21,20 @@ class App {
         virtual ~Action() = default;
     };
 
+    // Shows the rows of the map as they are read, takes no input but closing
+    struct LoadAction : public Action {
+        LoadAction(App& app_)
+            : app { app_ }
+        {
+        }
+        void poll(sf::Event& event) override;
+
+        void perform(sf::Event& event) override;
+
+    private:
+        App& app;
+    };
+
     struct EditAction : public Action {
         EditAction(App& app_)
             : app { app_ }
@@ -70,20 +88,86 @@ class App {
         App& app;
     };
 
+    // Graph and solver of the connectivity chosen at startup. The map is
+    // shown as the last search left it, until clear()
+    struct Session : public SearchView {
+        virtual gr::Graph& graph() = 0;
+        virtual void loadGraph() = 0;
+        [[nodiscard]] virtual bool done() = 0;
+        virtual void traceShortestPaths() = 0;
+        virtual void clear() = 0;
+        [[nodiscard]] virtual std::size_t expansions() const = 0;
+        [[nodiscard]] virtual std::size_t openSize() const = 0;
+    };
+
+    template <gr::Connectivity C>
+    struct BasicSession : public Session {
+        gr::Graph& graph() override { return grid; }
+        void loadGraph() override
+        {
+            paths.reset();
+            djk.loadGraph(grid);
+            searched = true;
+        }
+        [[nodiscard]] bool done() override { return djk.done(); }
+        void traceShortestPaths() override { paths = djk.shortestPaths(); }
+        void clear() override
+        {
+            paths.reset();
+            searched = false;
+        }
+        [[nodiscard]] std::size_t expansions() const override { return djk.expansions(); }
+        [[nodiscard]] std::size_t openSize() const override { return djk.openSize(); }
+
+        [[nodiscard]] gr::CharType shownType(gr::Vertex const& v) const override
+        {
+            if (!searched || v.isStart() || v.isEnd())
+                return v.type();
+            if (paths && paths->forks.contains(v.id()))
+                return gr::pointBifurcation;
+            if (paths && paths->cells.contains(v.id()))
+                return gr::pointShortest;
+            if (djk.settled(v.id()))
+                return gr::pointVisited;
+            if (djk.distance(v.id()) != gr::infinite)
+                return gr::pointFront;
+            return v.type();
+        }
+        [[nodiscard]] gr::Distance shownDistance(gr::Vertex const& v) const override { return djk.distance(v.id()); }
+        [[nodiscard]] gr::Distance maxDistance() const override { return djk.bound(); }
+
+    private:
+        using Solver = BasicDijkstra<gr::BasicGraph<C>>;
+
+        gr::BasicGraph<C> grid {};
+        Solver djk {};
+        std::optional<typename Solver::ShortestPaths> paths {};
+        bool searched {};
+    };
+
 public:
     App(Settings&& settings_, sf::RenderWindow& window_);
 
     void run();
 
 private:
+    static std::unique_ptr<Session> makeSession(gr::ConnectivityMode mode);
+    // Sizes the window for cells of the map
+    void fitWindow(gr::MapShape const& cells);
     void transition(Action& action);
     Settings settings;
     sf::RenderWindow& window;
-    gr::Graph graph {};
+    std::unique_ptr<Session> session {};
+    // While the map is read. Builds the session's graph, so declared after it
+    std::unique_ptr<gr::MapLoader> loader {};
+    // The rows read so far
+    gr::MapData loaded {};
+    // What the window is sized for while the map is read
+    gr::MapShape shape {};
     MouseEventHandler mouseEventHandler {};
-    // Dijkstra algorithm
-    Dijkstra djk {};
+    Hud hud { "Dijkstra" };
     // Possible states
+    LoadAction loadAction { *this };
     EditAction editAction { *this };
     PropagateAction propagateAction { *this };
     MarkAction markAction { *this };
@@ -0,0 +1,175 @@
+#ifndef CLEARANCE_HPP
+#define CLEARANCE_HPP
+
+#include "components.hpp"
+#include "connectivity.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace gr {
+
+// Chebyshev distance from a cell to the nearest obstacle, cells off the map
+// counting as obstacles: 0 on an obstacle, 1 next to one. Saturates at
+// maxClearance
+using Clearance = std::uint16_t;
+inline constexpr Clearance maxClearance { std::numeric_limits<Clearance>::max() };
+
+// What an agent of agentSize x agentSize cells, centred on the cell it
+// stands on, needs there. Even sizes take the room of the next odd one
+[[nodiscard]] constexpr Clearance clearanceFor(std::size_t agentSize)
+{
+    return static_cast<Clearance>(std::min<std::size_t>(agentSize / 2 + 1, maxClearance));
+}
+
+// What the end of each move of a policy needs. Diagonal moves of an agent
+// wider than a cell sweep past the squares at both ends, by a cell at two
+// corners, so they need one more. One cell agents keep the corner rules of
+// the policy
+template <Connectivity C>
+[[nodiscard]] constexpr std::array<Clearance, C::moves.size()> moveClearances(std::size_t agentSize)
+{
+    auto const need = clearanceFor(agentSize);
+    std::array<Clearance, C::moves.size()> result {};
+    for (std::size_t i = 0; i < result.size(); ++i) {
+        bool const diagonal = C::moves[i].dx != 0 && C::moves[i].dy != 0;
+        result[i] = diagonal && need > 1 && need < maxClearance ? static_cast<Clearance>(need + 1) : need;
+    }
+    return result;
+}
+
+// Clearance of a rows x cols map, row major, in two raster passes over a
+// copy padded with obstacles. Within a row, the step from the row above (or
+// below) has no dependency between columns and the compiler can vectorise
+// it; only the scan along the row is sequential
+template <typename Free>
+[[nodiscard]] std::vector<Clearance> computeClearance(std::size_t rows, std::size_t cols, Free&& free)
+{
+    auto const stride = cols + 2;
+    std::vector<Clearance> grid((rows + 2) * stride, 0);
+    std::vector<Clearance> step(stride, 0);
+    auto const plusOne = [](unsigned c) { return static_cast<Clearance>(std::min<unsigned>(c + 1, maxClearance)); };
+
+    for (std::size_t r = 1; r <= rows; ++r) {
+        auto* line = grid.data() + r * stride;
+        auto const* up = line - stride;
+        for (std::size_t c = 1; c <= cols; ++c)
+            line[c] = free(r - 1, c - 1) ? maxClearance : 0;
+        for (std::size_t c = 1; c <= cols; ++c)
+            step[c] = std::min(line[c], plusOne(std::min({ up[c - 1], up[c], up[c + 1] })));
+        for (std::size_t c = 1; c <= cols; ++c)
+            line[c] = std::min(step[c], plusOne(line[c - 1]));
+    }
+    for (std::size_t r = rows; r >= 1; --r) {
+        auto* line = grid.data() + r * stride;
+        auto const* down = line + stride;
+        for (std::size_t c = 1; c <= cols; ++c)
+            step[c] = std::min(line[c], plusOne(std::min({ down[c - 1], down[c], down[c + 1] })));
+        for (std::size_t c = cols; c >= 1; --c)
+            line[c] = std::min(step[c], plusOne(line[c + 1]));
+    }
+
+    std::vector<Clearance> result(rows * cols);
+    for (std::size_t r = 0; r < rows; ++r)
+        std::copy_n(grid.begin() + static_cast<std::ptrdiff_t>((r + 1) * stride + 1), cols, result.begin() + static_cast<std::ptrdiff_t>(r * cols));
+    return result;
+}
+
+// Half the side of the square around (row, col) whose clearances may change
+// when the cell turns from free to obstacle or back. at(row, col) reads the
+// clearances from before the edit, 0 off the map. A cell at distance d can
+// only change if its clearance is at least d, and none further out can
+// once a whole ring has none
+template <typename At>
+[[nodiscard]] std::int64_t clearanceReach(std::int64_t row, std::int64_t col, At&& at)
+{
+    std::int64_t reach {};
+    for (std::int64_t d = 1;; ++d) {
+        bool changes {};
+        for (std::int64_t i = -d; i <= d && !changes; ++i) {
+            changes = at(row - d, col + i) >= d || at(row + d, col + i) >= d
+                || at(row + i, col - d) >= d || at(row + i, col + d) >= d;
+        }
+        if (!changes)
+            return reach;
+        reach = d;
+    }
+}
+
+// Recomputes the clearances of the cells in rows [firstRow, lastRow) and
+// columns [firstCol, lastCol) from the cells around the window, which must
+// be up to date. at(row, col) reads a clearance, 0 off the map,
+// set(row, col, c) writes one and free(row, col) tells obstacles apart
+template <typename Free, typename At, typename Set>
+void refillClearance(std::int64_t firstRow, std::int64_t lastRow, std::int64_t firstCol, std::int64_t lastCol,
+    Free&& free, At&& at, Set&& set)
+{
+    auto const plusOne = [](unsigned c) { return static_cast<Clearance>(std::min<unsigned>(c + 1, maxClearance)); };
+    for (auto r = firstRow; r < lastRow; ++r) {
+        for (auto c = firstCol; c < lastCol; ++c) {
+            if (!free(r, c)) {
+                set(r, c, Clearance { 0 });
+                continue;
+            }
+            set(r, c, plusOne(std::min({ at(r, c - 1), at(r - 1, c - 1), at(r - 1, c), at(r - 1, c + 1) })));
+        }
+    }
+    for (auto r = lastRow - 1; r >= firstRow; --r) {
+        for (auto c = lastCol - 1; c >= firstCol; --c)
+            set(r, c, std::min(at(r, c), plusOne(std::min({ at(r, c + 1), at(r + 1, c + 1), at(r + 1, c), at(r + 1, c - 1) }))));
+    }
+}
+
+// A graph as an agent of a given size sees it: only the moves it fits
+// through are left. G provides forEachNeighbour(id, need, f) taking the
+// moveClearances of the agent
+template <typename G>
+class AgentView {
+public:
+    using VertexId = typename G::VertexId;
+    using DistanceType = typename G::DistanceType;
+
+    AgentView(G const& g_, std::size_t agentSize_)
+        : g { &g_ }
+        , agentSize { agentSize_ }
+        , need { moveClearances<typename G::ConnectivityType>(agentSize_) }
+    {
+    }
+
+    [[nodiscard]] G const& graph() const { return *g; }
+    [[nodiscard]] std::size_t size() const { return agentSize; }
+    // Whether the agent can stand on v
+    [[nodiscard]] bool fits(VertexId v) const { return g->clearance(v) >= clearanceFor(agentSize); }
+
+    [[nodiscard]] std::size_t vertexCount() const { return g->vertexCount(); }
+    [[nodiscard]] std::optional<VertexId> startId() const { return g->startId(); }
+    [[nodiscard]] std::optional<VertexId> endId() const { return g->endId(); }
+    [[nodiscard]] std::span<VertexId const> endIds() const { return g->endIds(); }
+    // Cells the graph puts apart are out of reach of any agent too
+    [[nodiscard]] ComponentId component(VertexId v) const
+        requires requires(G const& graph, VertexId id) { graph.component(id); }
+    {
+        return g->component(v);
+    }
+
+    template <typename F>
+    void forEachNeighbour(VertexId id, F&& f) const
+    {
+        g->forEachNeighbour(id, need, std::forward<F>(f));
+    }
+
+private:
+    G const* g;
+    std::size_t agentSize {};
+    std::array<Clearance, G::ConnectivityType::moves.size()> need {};
+};
+
+}
+
+#endif
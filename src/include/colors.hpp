@@ -8,6 +8,11 @@ inline sf::Color const shortestColor { 157, 60, 249 };
 inline sf::Color const frontColor { 255, 182, 108 };
 inline sf::Color const startColor { 0, 0, 255 };
 inline sf::Color const endColor { 255, 0, 0 };
+inline sf::Color const hudBackgroundColor { 0, 0, 0, 160 };
+inline sf::Color const hudPollColor { 80, 140, 255 };
+inline sf::Color const hudSolveColor { 255, 160, 40 };
+inline sf::Color const hudDrawColor { 60, 200, 90 };
+inline sf::Color const hudBudgetColor { 255, 60, 60 };
 
 namespace {
 
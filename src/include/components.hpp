@@ -0,0 +1,101 @@
+#ifndef COMPONENTS_HPP
+#define COMPONENTS_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace gr {
+
+// Label of a connected component. Two free cells share one when a path
+// joins them, obstacles have none
+using ComponentId = std::uint32_t;
+inline constexpr ComponentId noComponent { std::numeric_limits<ComponentId>::max() };
+
+namespace detail {
+    // Roots are the smallest vertex of their set, so every parent is at
+    // most its child
+    inline std::uint32_t findRoot(std::vector<std::uint32_t>& parent, std::uint32_t v)
+    {
+        while (parent[v] != v) {
+            parent[v] = parent[parent[v]];
+            v = parent[v];
+        }
+        return v;
+    }
+
+    inline void unite(std::vector<std::uint32_t>& parent, std::uint32_t a, std::uint32_t b)
+    {
+        a = findRoot(parent, a);
+        b = findRoot(parent, b);
+        if (a != b)
+            parent[std::max(a, b)] = std::min(a, b);
+    }
+}
+
+// Labels the components of a graph laid out in rows, row r spanning
+// [rowStart[r], rowStart[r + 1]), whose edges only join cells of the same
+// or of adjacent rows and go both ways. free(v) tells obstacles apart and
+// neighbours(v, f) calls f(n) for each neighbour of v. Bands of rows are
+// united by threads of their own, the edges between bands then joined and
+// labels handed out 0, 1, ... in cell order
+template <typename Free, typename Neighbours>
+[[nodiscard]] std::vector<ComponentId> labelComponents(std::span<std::size_t const> rowStart, Free&& free,
+    Neighbours&& neighbours, unsigned threads = 0)
+{
+    // Below this many rows per thread, starting threads costs more than it saves
+    constexpr std::size_t minBand { 256 };
+    auto const rows = rowStart.size() - 1;
+    auto const cellCount = rowStart.back();
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    auto const bands = std::clamp<std::size_t>(rows / minBand, 1, threads);
+
+    std::vector<std::uint32_t> parent(cellCount);
+    for (std::size_t v = 0; v < cellCount; ++v)
+        parent[v] = static_cast<std::uint32_t>(v);
+    // Cells of a band only ever point within it, so bands share no writes
+    auto const unite = [&](std::size_t firstRow, std::size_t lastRow, bool across) {
+        auto const begin = rowStart[firstRow];
+        auto const end = rowStart[lastRow];
+        for (auto v = across ? rowStart[lastRow - 1] : begin; v < end; ++v) {
+            if (!free(v))
+                continue;
+            neighbours(v, [&](std::size_t n) {
+                if (across ? n >= end : n > v && n < end)
+                    detail::unite(parent, static_cast<std::uint32_t>(v), static_cast<std::uint32_t>(n));
+            });
+        }
+    };
+    std::vector<std::size_t> bandStart(bands + 1);
+    for (std::size_t b = 0; b <= bands; ++b)
+        bandStart[b] = rows * b / bands;
+    {
+        std::vector<std::jthread> workers {};
+        workers.reserve(bands - 1);
+        for (std::size_t b = 1; b < bands; ++b)
+            workers.emplace_back([&, b] { unite(bandStart[b], bandStart[b + 1], false); });
+        unite(bandStart[0], bandStart[1], false);
+    }
+    for (std::size_t b = 1; b < bands; ++b)
+        unite(bandStart[b - 1], bandStart[b], true);
+
+    // Parents come first, so their labels are known by the time a cell is
+    // reached
+    std::vector<ComponentId> labels(cellCount, noComponent);
+    ComponentId next {};
+    for (std::size_t v = 0; v < cellCount; ++v) {
+        if (!free(v))
+            continue;
+        labels[v] = parent[v] == v ? next++ : labels[parent[v]];
+    }
+    return labels;
+}
+
+}
+
+#endif
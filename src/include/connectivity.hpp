@@ -0,0 +1,107 @@
+#ifndef CONNECTIVITY_HPP
+#define CONNECTIVITY_HPP
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <exception>
+#include <string_view>
+
+namespace gr {
+
+struct Move {
+    int dx {};
+    int dy {};
+    double cost {};
+};
+
+inline constexpr double diagonalCost { 1.4142135623730951 };
+
+// A connectivity policy lists the moves allowed from a cell and decides,
+// given free(dx, dy) for the cells around it, whether a move is legal.
+// The grid stores one mask bit per move, so there can be at most 8 of them.
+template <typename C>
+concept Connectivity = requires(int dx, int dy) {
+    { C::moves.size() } -> std::convertible_to<std::size_t>;
+    requires C::moves.size() <= 8;
+    { C::legal([](int, int) { return true; }, dx, dy) } -> std::same_as<bool>;
+};
+
+struct FourConnected {
+    inline static constexpr std::array<Move, 4> moves {
+        Move { 0, 1, 1. },
+        Move { 1, 0, 1. },
+        Move { -1, 0, 1. },
+        Move { 0, -1, 1. }
+    };
+
+    template <typename Free>
+    static constexpr bool legal(Free&& free, int dx, int dy)
+    {
+        return free(dx, dy);
+    }
+};
+
+// Diagonal moves may not touch an obstacle
+struct EightConnected {
+    inline static constexpr std::array<Move, 8> moves {
+        Move { 1, 1, diagonalCost },
+        Move { 0, 1, 1. },
+        Move { -1, 1, diagonalCost },
+        Move { 1, 0, 1. },
+        Move { -1, 0, 1. },
+        Move { 1, -1, diagonalCost },
+        Move { 0, -1, 1. },
+        Move { -1, -1, diagonalCost }
+    };
+
+    template <typename Free>
+    static constexpr bool legal(Free&& free, int dx, int dy)
+    {
+        return free(dx, dy) && (dx == 0 || dy == 0 || (free(dx, 0) && free(0, dy)));
+    }
+};
+
+// Diagonal moves may cut a corner, but not squeeze between two obstacles
+struct CornerCutting {
+    inline static constexpr auto moves = EightConnected::moves;
+
+    template <typename Free>
+    static constexpr bool legal(Free&& free, int dx, int dy)
+    {
+        return free(dx, dy) && (dx == 0 || dy == 0 || free(dx, 0) || free(0, dy));
+    }
+};
+
+// Runtime tag, used only to pick an instantiation once at startup
+enum class ConnectivityMode {
+    FOUR,
+    EIGHT,
+    CORNER_CUTTING,
+};
+
+class InvalidConnectivityException : std::exception {
+public:
+    const char* what() const noexcept override
+    {
+        return "Invalid connectivity, expected one of: 4, 8, 8-cut";
+    }
+};
+
+inline ConnectivityMode parseConnectivity(std::string_view str)
+{
+    if (str == "4")
+        return ConnectivityMode::FOUR;
+    if (str == "8")
+        return ConnectivityMode::EIGHT;
+    if (str == "8-cut")
+        return ConnectivityMode::CORNER_CUTTING;
+    throw InvalidConnectivityException {};
+}
+
+static_assert(Connectivity<FourConnected>);
+static_assert(Connectivity<EightConnected>);
+static_assert(Connectivity<CornerCutting>);
+}
+
+#endif
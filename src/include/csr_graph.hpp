@@ -0,0 +1,64 @@
+#ifndef CSR_GRAPH_HPP
+#define CSR_GRAPH_HPP
+
+#include "graph.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace gr {
+
+class InvalidEdgeListException : std::exception {
+public:
+    const char* what() const noexcept override
+    {
+        return "Invalid edge list entry";
+    }
+};
+
+// Compressed sparse row graph. The out-edges of v are
+// targets[offsets[v]] .. targets[offsets[v + 1] - 1]
+class CsrGraph {
+public:
+    using VertexId = std::uint32_t;
+    using DistanceType = Distance;
+
+    struct Edge {
+        VertexId from {};
+        VertexId to {};
+        Distance weight {};
+    };
+
+    CsrGraph() = default;
+    CsrGraph(std::size_t vertices, std::span<Edge const> edges);
+
+    // One "from to weight" triple per line. Empty lines and lines starting
+    // with '#' are skipped. With symmetric every edge is added both ways.
+    // Throws InvalidEdgeListException on a malformed line or a weight that
+    // is negative or not finite
+    void fromEdgeList(std::string_view fname, bool symmetric = false);
+
+    [[nodiscard]] std::size_t vertexCount() const { return offsets.size() - 1; }
+    [[nodiscard]] std::size_t edgeCount() const { return targets.size(); }
+
+    template <typename F>
+    void forEachNeighbour(VertexId id, F&& f) const
+    {
+        for (auto e = offsets[id]; e < offsets[id + 1]; ++e)
+            f(targets[e], weights[e]);
+    }
+
+private:
+    void build(std::size_t vertices, std::span<Edge const> edges);
+
+    std::vector<std::size_t> offsets { 0 };
+    std::vector<VertexId> targets {};
+    std::vector<Distance> weights {};
+};
+
+}
+
+#endif
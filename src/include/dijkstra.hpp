@@ -2,33 +2,456 @@
 #define DIJKSTRA_HPP
 
 #include "graph.hpp"
+#include "graph_concept.hpp"
+#include "open_list.hpp"
+#include "scratch_arena.hpp"
+#include "search_state.hpp"
+#include <algorithm>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <memory>
 #include <optional>
-#include <set>
+#include <span>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
-class Dijkstra {
+enum class SearchStatus {
+    RUNNING,
+    // Every wanted target is settled
+    FOUND,
+    // Nothing left to expand, reached() may hold some of the targets
+    UNREACHABLE,
+    // Cutoffs, reached() holds the targets settled before. The best partial
+    // result is then nearest(): of the vertices settled within the limits,
+    // the one the heuristic puts closest to the targets, the last settled
+    // among equals. Without a heuristic that is the one farthest from the
+    // source
+    COST_LIMIT,
+    EXPANSION_LIMIT,
+    DEADLINE,
+};
+
+// Per query bounds on the work of a search
+template <typename D>
+struct SearchLimits {
+    // No target costlier than this is looked for
+    std::optional<D> maxCost {};
+    std::optional<std::size_t> maxExpansions {};
+    std::optional<std::chrono::steady_clock::time_point> deadline {};
+};
+
+// Lower bounds on the distance from a vertex to the nearest of the targets
+// given to aim(). Turns the search into A*, which settles targets in the
+// same order as long as the bound is consistent: it never drops by more
+// than the weight of an edge.
+template <typename H, typename D, typename Id>
+concept Heuristic = std::default_initializable<H> && requires(H& h, H const& ch, Id v, std::span<Id const> targets) {
+    h.aim(targets);
+    { ch(v) } -> std::same_as<D>;
+};
+
+// Plain Dijkstra
+template <typename D, typename Id>
+struct NoHeuristic {
+    void aim(std::span<Id const>) { }
+    [[nodiscard]] D operator()(Id) const { return D { 0 }; }
+};
+
+template <gr::SearchGraph G,
+    typename Open = SetOpenList<typename G::DistanceType, typename G::VertexId>,
+    typename H = NoHeuristic<typename G::DistanceType, typename G::VertexId>>
+    requires OpenList<Open, typename G::DistanceType, typename G::VertexId>
+    && Heuristic<H, typename G::DistanceType, typename G::VertexId>
+class BasicDijkstra {
 public:
-    Dijkstra(gr::Graph& g);
-    Dijkstra() = default;
+    using VertexId = typename G::VertexId;
+    using DistanceType = typename G::DistanceType;
+
+    BasicDijkstra(G const& g)
+        requires gr::EndpointGraph<G>;
+    BasicDijkstra() = default;
 
-    void loadGraph(gr::Graph& g);
+    // Searches for the nearest of the graph's ends when it has several. A
+    // graph without a start or an end is UNREACHABLE at once
+    void loadGraph(G const& g)
+        requires gr::EndpointGraph<G>;
+    void loadGraph(G const& g, VertexId source, VertexId target);
+    // Stops once the k nearest of targets are settled, or when no other one
+    // can be reached. On a ComponentGraph the targets in other components
+    // than source are known to be out of reach and never searched for
+    void loadGraph(G const& g, VertexId source, std::span<VertexId const> targets, std::size_t k = 1);
+    // Settles every vertex that can be reached from source
+    void loadGraph(G const& g, VertexId source);
+    // For the query loaded last, cleared by loadGraph
+    void setLimits(SearchLimits<DistanceType> const& l) { limits = l; }
+    // Kept for the next queries, aimed at their targets by loadGraph
+    void setHeuristic(H h) { heuristic = std::move(h); }
 
+    // Settles one vertex. Returns true once the search is over
     [[nodiscard]] bool done();
+    // Runs done() until the search is over
+    void run();
 
-    void markShortestPaths();
+    [[nodiscard]] SearchStatus status() const { return stat; }
+    // No target left unsettled is closer than this
+    [[nodiscard]] DistanceType bound() const { return frontier; }
+    // To the nearest target, empty if none was reached
+    [[nodiscard]] std::optional<DistanceType> cost() const;
+    [[nodiscard]] std::size_t expansions() const { return expanded; }
+    // Reached vertices waiting to be settled. Unlike the size of the open
+    // list, stale entries left by a lazy decrease are not counted
+    [[nodiscard]] std::size_t openSize() const { return waiting; }
+    // From source to the nearest target, empty if none was reached
+    [[nodiscard]] std::vector<VertexId> path() const;
+    // From source to a settled vertex, such as one of reached()
+    [[nodiscard]] std::vector<VertexId> path(VertexId to) const;
+    // The targets settled so far, nearest first
+    [[nodiscard]] std::span<VertexId const> reached() const { return found; }
+    // The settled vertex that looks closest to the targets, see SearchStatus
+    [[nodiscard]] VertexId nearest() const { return best; }
+    // Exact for settled vertices, an upper bound for the others
+    [[nodiscard]] DistanceType distance(VertexId v) const { return distOf(v); }
+    // Reached vertices that are not settled make up the front of the search
+    [[nodiscard]] bool settled(VertexId v) const { return state.settled(v); }
+
+    // Every shortest path to the reached targets, not just the one path()
+    // follows. Neither the source nor the targets are part of them
+    struct ShortestPaths {
+        std::unordered_set<VertexId> cells {};
+        // Where the paths split
+        std::unordered_set<VertexId> forks {};
+    };
+    [[nodiscard]] ShortestPaths shortestPaths() const;
 
 private:
-    void init(gr::Graph& g);
     void reset();
 
-    void traverse(gr::Graph::VertexType const& v);
+    void traverse(VertexId v, ShortestPaths& paths) const;
+
+    // Ends the search with the given status
+    bool finish(SearchStatus s)
+    {
+        stat = s;
+        return true;
+    }
+    [[nodiscard]] bool isTarget(VertexId v) const
+    {
+        return targets.size() == 1 ? v == targets.front() : std::ranges::binary_search(targets, v);
+    }
 
-    [[nodiscard]] bool completed() const;
+    // Skips the entries made stale by a lazy decrease
+    [[nodiscard]] std::optional<std::pair<DistanceType, VertexId>> extractFirst();
 
-    [[nodiscard]] gr::Graph::VertexType extractFirst();
+    [[nodiscard]] DistanceType distOf(VertexId v) const { return state.dist(v); }
+    // What the open list is ordered by
+    [[nodiscard]] DistanceType keyOf(VertexId v, DistanceType d) const
+    {
+        if constexpr (std::same_as<H, NoHeuristic<DistanceType, VertexId>>)
+            return d;
+        else
+            return d + heuristic(v);
+    }
 
-    gr::Graph* graph { nullptr };
-    std::optional<gr::Graph::VertexType> dst {};
-    std::set<gr::Graph::VertexType> unvisited {};
+    G const* graph { nullptr };
+    VertexId source {};
+    // Sorted. Cleared rather than freed between queries, like found
+    std::vector<VertexId> targets {};
+    std::vector<VertexId> found {};
+    std::size_t wanted {};
+    // Of the k wanted, how many were known to be out of reach
+    std::size_t missing {};
+    SearchLimits<DistanceType> limits {};
+    SearchStatus stat { SearchStatus::UNREACHABLE };
+    DistanceType frontier {};
+    // nearest() and what the heuristic gives for it
+    VertexId best {};
+    DistanceType bestEstimate {};
+    // Per query containers live in the arena and are rebuilt by loadGraph.
+    // Declared first, so that it outlives them
+    std::unique_ptr<ScratchArena> arena { std::make_unique<ScratchArena>() };
+    std::conditional_t<gr::SparseGraph<G>, SparseState<DistanceType, VertexId>, DenseState<DistanceType, VertexId>> state {};
+    std::optional<Open> unvisited {};
+    // The entries of unvisited that are not stale
+    std::size_t waiting {};
+    std::size_t expanded {};
+    H heuristic {};
 };
 
-#endif
\ No newline at end of file
+template <gr::SearchGraph G, typename Open, typename H>
+    requires OpenList<Open, typename G::DistanceType, typename G::VertexId>
+    && Heuristic<H, typename G::DistanceType, typename G::VertexId>
+BasicDijkstra<G, Open, H>::BasicDijkstra(G const& g)
+    requires gr::EndpointGraph<G>
+{
+    loadGraph(g);
+}
+
+template <gr::SearchGraph G, typename Open, typename H>
+    requires OpenList<Open, typename G::DistanceType, typename G::VertexId>
+    && Heuristic<H, typename G::DistanceType, typename G::VertexId>
+void BasicDijkstra<G, Open, H>::loadGraph(G const& g)
+    requires gr::EndpointGraph<G>
+{
+    reset();
+    auto const start = g.startId();
+    if (!start) {
+        // Nothing to search, but every vertex can still be asked about and
+        // reads as unreached
+        graph = &g;
+        state.reset(g.vertexCount(), VertexId {}, arena->resource());
+        return;
+    }
+    if constexpr (gr::MultiGoalGraph<G>) {
+        loadGraph(g, *start, g.endIds());
+    } else if (auto const end = g.endId()) {
+        loadGraph(g, *start, *end);
+    } else {
+        // No target, UNREACHABLE at once
+        loadGraph(g, *start, std::span<VertexId const> {});
+    }
+}
+
+template <gr::SearchGraph G, typename Open, typename H>
+    requires OpenList<Open, typename G::DistanceType, typename G::VertexId>
+    && Heuristic<H, typename G::DistanceType, typename G::VertexId>
+void BasicDijkstra<G, Open, H>::loadGraph(G const& g, VertexId source_, VertexId target)
+{
+    loadGraph(g, source_, { &target, 1 });
+}
+
+template <gr::SearchGraph G, typename Open, typename H>
+    requires OpenList<Open, typename G::DistanceType, typename G::VertexId>
+    && Heuristic<H, typename G::DistanceType, typename G::VertexId>
+void BasicDijkstra<G, Open, H>::loadGraph(G const& g, VertexId source_, std::span<VertexId const> targets_, std::size_t k)
+{
+    reset();
+    graph = &g;
+    source = source_;
+    targets.assign(targets_.begin(), targets_.end());
+    std::ranges::sort(targets);
+    targets.erase(std::ranges::unique(targets).begin(), targets.end());
+    wanted = std::min(k, targets.size());
+    if constexpr (gr::ComponentGraph<G>) {
+        // Obstacles have no component, a search from one goes on as usual
+        if (auto const c = g.component(source_); c != gr::noComponent) {
+            std::erase_if(targets, [&](VertexId t) { return t != source_ && g.component(t) != c; });
+            missing = wanted - std::min(wanted, targets.size());
+            wanted -= missing;
+        }
+    }
+    stat = wanted != 0                        ? SearchStatus::RUNNING
+        : targets.empty() || missing != 0 ? SearchStatus::UNREACHABLE
+                                          : SearchStatus::FOUND;
+    heuristic.aim(targets);
+    unvisited.emplace(arena->resource());
+    state.reset(g.vertexCount(), source, arena->resource());
+    state.set(source, DistanceType { 0 }, source);
+    unvisited->push(keyOf(source, distOf(source)), source);
+    waiting = 1;
+    best = source;
+    bestEstimate = keyOf(source, DistanceType { 0 });
+}
+
+template <gr::SearchGraph G, typename Open, typename H>
+    requires OpenList<Open, typename G::DistanceType, typename G::VertexId>
+    && Heuristic<H, typename G::DistanceType, typename G::VertexId>
+void BasicDijkstra<G, Open, H>::loadGraph(G const& g, VertexId source_)
+{
+    loadGraph(g, source_, std::span<VertexId const> {});
+    stat = SearchStatus::RUNNING;
+}
+
+template <gr::SearchGraph G, typename Open, typename H>
+    requires OpenList<Open, typename G::DistanceType, typename G::VertexId>
+    && Heuristic<H, typename G::DistanceType, typename G::VertexId>
+void BasicDijkstra<G, Open, H>::reset()
+{
+    targets.clear();
+    found.clear();
+    wanted = 0;
+    missing = 0;
+    limits = {};
+    stat = SearchStatus::UNREACHABLE;
+    frontier = DistanceType { 0 };
+    best = VertexId {};
+    bestEstimate = DistanceType { 0 };
+    // The arena can only be rewound once nothing lives in it
+    unvisited.reset();
+    waiting = 0;
+    state.release();
+    arena->rewind();
+    expanded = 0;
+    graph = nullptr;
+}
+
+template <gr::SearchGraph G, typename Open, typename H>
+    requires OpenList<Open, typename G::DistanceType, typename G::VertexId>
+    && Heuristic<H, typename G::DistanceType, typename G::VertexId>
+bool BasicDijkstra<G, Open, H>::done()
+{
+    // Reading the clock costs more than an expansion, so it is only read
+    // every so often
+    constexpr std::size_t deadlineStride { 256 };
+
+    if (stat != SearchStatus::RUNNING)
+        return true;
+    if (limits.maxExpansions && expanded >= *limits.maxExpansions)
+        return finish(SearchStatus::EXPANSION_LIMIT);
+    if (limits.deadline && expanded % deadlineStride == 0
+        && std::chrono::steady_clock::now() >= *limits.deadline)
+        return finish(SearchStatus::DEADLINE);
+
+    auto const first = extractFirst();
+    if (!first.has_value())
+        return finish(SearchStatus::UNREACHABLE);
+    auto const [currentKey, current] = *first;
+    auto const currentDist = distOf(current);
+    state.settle(current);
+    waiting -= 1;
+    frontier = currentKey;
+    // Settled in order of key, a bound on the cost of the targets reached
+    // through them: everything left is costlier still
+    if (limits.maxCost && *limits.maxCost < currentKey)
+        return finish(SearchStatus::COST_LIMIT);
+    expanded += 1;
+    if (auto const estimate = keyOf(current, DistanceType { 0 }); estimate <= bestEstimate) {
+        best = current;
+        bestEstimate = estimate;
+    }
+    if (isTarget(current)) {
+        found.push_back(current);
+        if (found.size() == wanted)
+            return finish(missing == 0 ? SearchStatus::FOUND : SearchStatus::UNREACHABLE);
+    }
+    graph->forEachNeighbour(current, [&](VertexId node, DistanceType d) {
+        if (node == source)
+            return;
+
+        if (DistanceType tentativeDist = currentDist + d;
+            tentativeDist < distOf(node)) {
+            // A heuristic may reopen a settled vertex, whose entry is gone:
+            // decrease() then just pushes the new one, and it waits again
+            if (distOf(node) != gr::infiniteDistance<DistanceType>) {
+                waiting += state.settled(node);
+                unvisited->decrease(keyOf(node, distOf(node)), keyOf(node, tentativeDist), node);
+            } else {
+                waiting += 1;
+                unvisited->push(keyOf(node, tentativeDist), node);
+            }
+            state.set(node, tentativeDist, current);
+        }
+    });
+
+    return false;
+}
+
+template <gr::SearchGraph G, typename Open, typename H>
+    requires OpenList<Open, typename G::DistanceType, typename G::VertexId>
+    && Heuristic<H, typename G::DistanceType, typename G::VertexId>
+void BasicDijkstra<G, Open, H>::run()
+{
+    while (!done()) { }
+}
+
+template <gr::SearchGraph G, typename Open, typename H>
+    requires OpenList<Open, typename G::DistanceType, typename G::VertexId>
+    && Heuristic<H, typename G::DistanceType, typename G::VertexId>
+auto BasicDijkstra<G, Open, H>::cost() const -> std::optional<DistanceType>
+{
+    if (found.empty())
+        return std::nullopt;
+    return distOf(found.front());
+}
+
+template <gr::SearchGraph G, typename Open, typename H>
+    requires OpenList<Open, typename G::DistanceType, typename G::VertexId>
+    && Heuristic<H, typename G::DistanceType, typename G::VertexId>
+std::vector<typename BasicDijkstra<G, Open, H>::VertexId> BasicDijkstra<G, Open, H>::path() const
+{
+    if (found.empty())
+        return {};
+    return path(found.front());
+}
+
+template <gr::SearchGraph G, typename Open, typename H>
+    requires OpenList<Open, typename G::DistanceType, typename G::VertexId>
+    && Heuristic<H, typename G::DistanceType, typename G::VertexId>
+std::vector<typename BasicDijkstra<G, Open, H>::VertexId> BasicDijkstra<G, Open, H>::path(VertexId to) const
+{
+    std::vector<VertexId> result {};
+    if (distOf(to) == gr::infiniteDistance<DistanceType>)
+        return result;
+    for (auto v = to; v != source; v = state.pred(v))
+        result.push_back(v);
+    result.push_back(source);
+    std::ranges::reverse(result);
+    return result;
+}
+
+template <gr::SearchGraph G, typename Open, typename H>
+    requires OpenList<Open, typename G::DistanceType, typename G::VertexId>
+    && Heuristic<H, typename G::DistanceType, typename G::VertexId>
+auto BasicDijkstra<G, Open, H>::shortestPaths() const -> ShortestPaths
+{
+    ShortestPaths paths {};
+    for (auto goal : found)
+        traverse(goal, paths);
+    return paths;
+}
+
+template <gr::SearchGraph G, typename Open, typename H>
+    requires OpenList<Open, typename G::DistanceType, typename G::VertexId>
+    && Heuristic<H, typename G::DistanceType, typename G::VertexId>
+void BasicDijkstra<G, Open, H>::traverse(VertexId v, ShortestPaths& paths) const
+{
+    if (v == source)
+        return;
+
+    std::vector<VertexId> neigh {};
+    neigh.reserve(8);
+    graph->forEachNeighbour(v, [&](VertexId node, DistanceType) { neigh.push_back(node); });
+    if (neigh.empty())
+        return;
+    auto const nearest = *std::ranges::min_element(neigh, [&](VertexId a, VertexId b) {
+        return distOf(a) < distOf(b);
+    });
+
+    for (auto node : neigh) {
+        if (distOf(node) > distOf(nearest)
+            || node == source
+            || isTarget(node)
+            || paths.cells.contains(node))
+            continue;
+        if (nearest != node && !isTarget(v))
+            paths.forks.insert(v);
+        paths.cells.insert(node);
+        traverse(node, paths);
+    }
+}
+
+template <gr::SearchGraph G, typename Open, typename H>
+    requires OpenList<Open, typename G::DistanceType, typename G::VertexId>
+    && Heuristic<H, typename G::DistanceType, typename G::VertexId>
+auto BasicDijkstra<G, Open, H>::extractFirst() -> std::optional<std::pair<DistanceType, VertexId>>
+{
+    while (!unvisited->empty()) {
+        auto const entry = unvisited->pop();
+        if (entry.first == keyOf(entry.second, distOf(entry.second)))
+            return entry;
+    }
+    return std::nullopt;
+}
+
+extern template class BasicDijkstra<gr::BasicGraph<gr::FourConnected>>;
+extern template class BasicDijkstra<gr::BasicGraph<gr::EightConnected>>;
+extern template class BasicDijkstra<gr::BasicGraph<gr::CornerCutting>>;
+using Dijkstra = BasicDijkstra<gr::BasicGraph<gr::EightConnected>>;
+
+template <gr::Connectivity C>
+using RadixDijkstra = BasicDijkstra<gr::BasicGraph<C, gr::IntDistance>,
+    RadixHeap<gr::IntDistance, typename gr::BasicGraph<C, gr::IntDistance>::VertexId>>;
+
+#endif
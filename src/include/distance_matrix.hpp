@@ -0,0 +1,85 @@
+#ifndef DISTANCE_MATRIX_HPP
+#define DISTANCE_MATRIX_HPP
+
+#include "dijkstra.hpp"
+#include "graph.hpp"
+#include "graph_concept.hpp"
+#include "open_list.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace gr {
+
+// Costs between every pair of a set of points, row i holding the costs from
+// points[i]. Pairs with no path cost infiniteDistance
+template <typename D, typename Id>
+struct DistanceMatrix {
+    std::size_t size {};
+    std::vector<D> costs {};
+    // Row major like costs, only filled when asked for. Empty for pairs with
+    // no path
+    std::vector<std::vector<Id>> paths {};
+
+    [[nodiscard]] D cost(std::size_t from, std::size_t to) const { return costs[from * size + to]; }
+    [[nodiscard]] std::span<Id const> path(std::size_t from, std::size_t to) const { return paths[from * size + to]; }
+};
+
+struct MatrixOptions {
+    // 0 picks one per hardware thread
+    unsigned threads {};
+    bool paths {};
+};
+
+// One search per row, from its point until every other point is settled,
+// instead of one per pair. Rows are shared out between threads, each with a
+// solver of its own over the same graph, which must be safe to read from
+// several threads at once. Sparse graphs are left out: a TiledGraph pages
+// its tiles in on reads
+template <SearchGraph G, typename Open = SetOpenList<typename G::DistanceType, typename G::VertexId>>
+    requires(!SparseGraph<G>)
+[[nodiscard]] DistanceMatrix<typename G::DistanceType, typename G::VertexId> distanceMatrix(
+    G const& g, std::span<typename G::VertexId const> points, MatrixOptions const& options = {})
+{
+    using D = typename G::DistanceType;
+    using Id = typename G::VertexId;
+
+    DistanceMatrix<D, Id> matrix {};
+    matrix.size = points.size();
+    matrix.costs.assign(points.size() * points.size(), infiniteDistance<D>);
+    if (options.paths)
+        matrix.paths.resize(points.size() * points.size());
+
+    std::atomic<std::size_t> nextRow {};
+    auto work = [&] {
+        BasicDijkstra<G const, Open> djk {};
+        for (auto i = nextRow.fetch_add(1, std::memory_order_relaxed); i < points.size();
+             i = nextRow.fetch_add(1, std::memory_order_relaxed)) {
+            djk.loadGraph(g, points[i], points, points.size());
+            djk.run();
+            for (std::size_t j = 0; j < points.size(); ++j) {
+                if (!djk.settled(points[j]))
+                    continue;
+                matrix.costs[i * points.size() + j] = djk.distance(points[j]);
+                if (options.paths)
+                    matrix.paths[i * points.size() + j] = djk.path(points[j]);
+            }
+        }
+    };
+
+    auto threads = options.threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : options.threads;
+    threads = static_cast<unsigned>(std::min<std::size_t>(threads, std::max<std::size_t>(points.size(), 1)));
+    std::vector<std::jthread> workers {};
+    workers.reserve(threads - 1);
+    for (unsigned t = 1; t < threads; ++t)
+        workers.emplace_back(work);
+    work();
+    return matrix;
+}
+
+}
+
+#endif
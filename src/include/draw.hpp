@@ -6,6 +6,20 @@
 #include "settings.hpp"
 #include <vector>
 
-void drawGrid(gr::Graph const& graph, sf::RenderWindow& window, CellSize const& cellSize);
+// What a search shows over the cells of the map it runs on
+class SearchView {
+public:
+    // One of the map types, or one of pointVisited, pointFront,
+    // pointShortest and pointBifurcation
+    [[nodiscard]] virtual gr::CharType shownType(gr::Vertex const& v) const = 0;
+    [[nodiscard]] virtual gr::Distance shownDistance(gr::Vertex const& v) const = 0;
+    // Of the cells shown as visited, for their color
+    [[nodiscard]] virtual gr::Distance maxDistance() const = 0;
+    virtual ~SearchView() = default;
+};
+
+void drawGrid(gr::Graph const& graph, SearchView const& view, sf::RenderWindow& window, CellSize const& cellSize);
+// The rows of a map still being loaded, as they are in the file
+void drawMap(gr::MapData const& map, sf::RenderWindow& window, CellSize const& cellSize);
 
 #endif
\ No newline at end of file
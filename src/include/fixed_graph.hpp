@@ -0,0 +1,202 @@
+#ifndef FIXED_GRAPH_HPP
+#define FIXED_GRAPH_HPP
+
+#include "connectivity.hpp"
+#include "graph.hpp"
+#include "graph_concept.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <utility>
+
+namespace gr {
+
+class InvalidMapSizeException : std::exception {
+public:
+    const char* what() const noexcept override
+    {
+        return "Map size differs from the fixed grid size";
+    }
+};
+
+// A grid of Rows x Cols cells known at compile time, for small maps of a
+// known size. The grid is stored inline, so building and editing it never
+// allocates. Only the grid: a solver keeps its per query state in a
+// DenseState and a ScratchArena as on any graph, allocated by its first
+// query and reused by the next ones. A move's offset is a constant and moves off the grid are never
+// in a cell's mask, so visiting the neighbours of a cell needs no bounds
+// check nor row lookup. Same ids, endpoints and moves as a BasicGraph of the
+// same map.
+template <std::size_t Rows, std::size_t Cols, Connectivity C, typename D = Distance>
+class FixedGraph {
+public:
+    using VertexId = Vertex::UniqueIdType;
+    using DistanceType = D;
+    using ConnectivityType = C;
+    inline static constexpr std::size_t rows { Rows };
+    inline static constexpr std::size_t cols { Cols };
+    inline static constexpr std::size_t closests { C::moves.size() };
+
+    static_assert(Rows > 0 && Cols > 1, "buildEmpty needs room for both endpoints");
+    static_assert(Rows * Cols <= static_cast<std::size_t>(std::numeric_limits<VertexId>::max()));
+
+    FixedGraph() { buildEmpty(); }
+
+    // Throws InvalidMapSizeException unless every row of the map is Cols
+    // cells long and there are Rows of them
+    void fromMap(MapData const& map);
+    void fromFile(std::string_view fname) { fromMap(loadMap(fname)); }
+    // Empty cells, the start on the first and the end on the second
+    void buildEmpty();
+
+    [[nodiscard]] static constexpr std::size_t vertexCount() { return Rows * Cols; }
+    [[nodiscard]] static constexpr VertexId idAt(std::size_t row, std::size_t col)
+    {
+        return static_cast<VertexId>(row * Cols + col);
+    }
+    [[nodiscard]] static constexpr Position position(VertexId id)
+    {
+        return { X { static_cast<int>(static_cast<std::size_t>(id) / Cols) }, Y { static_cast<int>(static_cast<std::size_t>(id) % Cols) } };
+    }
+    [[nodiscard]] CharType type(VertexId id) const { return types[static_cast<std::size_t>(id)]; }
+    [[nodiscard]] NeighbourMask moves(VertexId id) const { return moveMask[static_cast<std::size_t>(id)]; }
+    // Placing a start clears the previous one, an end is added to the
+    // others. Throws InvalidGraphException unless the type is one of a map
+    void markAs(VertexId id, CharType type);
+
+    [[nodiscard]] std::optional<VertexId> startId() const { return start; }
+    [[nodiscard]] std::optional<VertexId> endId() const
+    {
+        return endCount == 0 ? std::nullopt : std::optional<VertexId> { ends.front() };
+    }
+    [[nodiscard]] std::span<VertexId const> endIds() const { return { ends.data(), endCount }; }
+    // Changes whenever the map does, like Graph::version
+    [[nodiscard]] std::uint64_t version() const { return mapVersion; }
+
+    template <typename F>
+    void forEachNeighbour(VertexId id, F&& f) const
+    {
+        auto const mask = moveMask[static_cast<std::size_t>(id)];
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            ((mask & (1u << I) ? (void)f(static_cast<VertexId>(id + offset[I]), cost[I]) : void()), ...);
+        }(std::make_index_sequence<closests> {});
+    }
+
+private:
+    inline static constexpr auto cost = moveCosts<C, D>;
+    inline static constexpr auto offset = []<std::size_t... I>(std::index_sequence<I...>) {
+        return std::array<VertexId, closests> { static_cast<VertexId>(C::moves[I].dx * static_cast<int>(Cols) + C::moves[I].dy)... };
+    }(std::make_index_sequence<closests> {});
+
+    [[nodiscard]] bool isFree(std::ptrdiff_t row, std::ptrdiff_t col) const
+    {
+        return row >= 0 && col >= 0 && row < static_cast<std::ptrdiff_t>(Rows) && col < static_cast<std::ptrdiff_t>(Cols)
+            && types[static_cast<std::size_t>(row) * Cols + static_cast<std::size_t>(col)] != pointObstacle;
+    }
+    void computeMoves();
+    void updateMoves(std::size_t row, std::size_t col);
+
+    std::array<CharType, Rows * Cols> types {};
+    // Bit i is set when C::moves[i] is legal, as in Graph
+    std::array<NeighbourMask, Rows * Cols> moveMask {};
+    std::optional<VertexId> start {};
+    // The first endCount of them, in the order they were marked
+    std::array<VertexId, Rows * Cols> ends {};
+    std::size_t endCount {};
+    std::uint64_t mapVersion {};
+};
+
+template <std::size_t Rows, std::size_t Cols, Connectivity C, typename D>
+void FixedGraph<Rows, Cols, C, D>::fromMap(MapData const& map)
+{
+    if (map.rowCount() != Rows)
+        throw InvalidMapSizeException {};
+    for (std::size_t r = 0; r < Rows; ++r) {
+        if (map.rowStart[r + 1] - map.rowStart[r] != Cols)
+            throw InvalidMapSizeException {};
+    }
+    std::ranges::copy(map.cells, types.begin());
+    start = map.start ? std::optional<VertexId> { static_cast<VertexId>(*map.start) } : std::nullopt;
+    endCount = std::min(map.ends.size(), ends.size());
+    std::ranges::transform(map.ends.begin(), map.ends.begin() + static_cast<std::ptrdiff_t>(endCount), ends.begin(),
+        [](std::size_t e) { return static_cast<VertexId>(e); });
+    mapVersion += 1;
+    computeMoves();
+}
+
+template <std::size_t Rows, std::size_t Cols, Connectivity C, typename D>
+void FixedGraph<Rows, Cols, C, D>::buildEmpty()
+{
+    types.fill(pointEmpty);
+    types[0] = pointStart;
+    types[1] = pointEnd;
+    start = 0;
+    ends[0] = 1;
+    endCount = 1;
+    mapVersion += 1;
+    computeMoves();
+}
+
+template <std::size_t Rows, std::size_t Cols, Connectivity C, typename D>
+void FixedGraph<Rows, Cols, C, D>::computeMoves()
+{
+    for (std::size_t r = 0; r < Rows; ++r)
+        for (std::size_t c = 0; c < Cols; ++c)
+            moveMask[r * Cols + c] = movesFrom<C>([&](int dx, int dy) {
+                return isFree(static_cast<std::ptrdiff_t>(r) + dx, static_cast<std::ptrdiff_t>(c) + dy);
+            });
+}
+
+template <std::size_t Rows, std::size_t Cols, Connectivity C, typename D>
+void FixedGraph<Rows, Cols, C, D>::markAs(VertexId id, CharType type)
+{
+    switch (type) {
+    case pointEmpty:
+    case pointObstacle:
+    case pointStart:
+    case pointEnd:
+        break;
+    default:
+        throw InvalidGraphException {};
+    }
+
+    mapVersion += 1;
+    auto& cell = types[static_cast<std::size_t>(id)];
+    bool const wasObstacle = cell == pointObstacle;
+    if (start == id)
+        start = std::nullopt;
+    auto const kept = std::remove(ends.begin(), ends.begin() + static_cast<std::ptrdiff_t>(endCount), id);
+    endCount = static_cast<std::size_t>(kept - ends.begin());
+    cell = type;
+    if (type == pointStart) {
+        if (start)
+            types[static_cast<std::size_t>(*start)] = pointEmpty;
+        start = id;
+    } else if (type == pointEnd) {
+        ends[endCount++] = id;
+    }
+    if (wasObstacle != (type == pointObstacle))
+        updateMoves(static_cast<std::size_t>(id) / Cols, static_cast<std::size_t>(id) % Cols);
+}
+
+template <std::size_t Rows, std::size_t Cols, Connectivity C, typename D>
+void FixedGraph<Rows, Cols, C, D>::updateMoves(std::size_t row, std::size_t col)
+{
+    // Only the 3x3 block around a toggled cell can see its legality change
+    for (std::size_t r = row == 0 ? 0 : row - 1; r <= std::min(row + 1, Rows - 1); ++r)
+        for (std::size_t c = col == 0 ? 0 : col - 1; c <= std::min(col + 1, Cols - 1); ++c)
+            moveMask[r * Cols + c] = movesFrom<C>([&](int dx, int dy) {
+                return isFree(static_cast<std::ptrdiff_t>(r) + dx, static_cast<std::ptrdiff_t>(c) + dy);
+            });
+}
+
+static_assert(MultiGoalGraph<FixedGraph<25, 50, EightConnected>>);
+}
+
+#endif
@@ -1,13 +1,23 @@
 #ifndef GRAPH_H
 #define GRAPH_H
 
+#include "clearance.hpp"
+#include "components.hpp"
+#include "connectivity.hpp"
 #include "number.hpp"
 #include "optional_pointer.hpp"
+#include <array>
 #include <compare>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
 #include <exception>
 #include <functional>
 #include <limits>
+#include <optional>
 #include <ostream>
+#include <span>
+#include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
@@ -17,7 +27,13 @@ namespace gr {
 using X = num::Number<int, struct TypeX>;
 using Y = num::Number<int, struct TypeY>;
 using Distance = num::Number<double, struct Dist>;
+// Fixed point distance for solvers that need integer keys. Unit moves cost
+// intDistanceScale, diagonals round(intDistanceScale * sqrt(2))
+using IntDistance = num::Number<std::uint64_t, struct IntDist>;
+inline constexpr std::uint64_t intDistanceScale { 1000 };
 enum CharType : unsigned char {};
+// One bit per move of a connectivity policy
+using NeighbourMask = std::uint8_t;
 
 struct Position {
     X x;
@@ -39,7 +55,37 @@ inline constexpr CharType pointVisited { '.' };
 inline constexpr CharType pointFront { 'f' };
 inline constexpr CharType pointStart { 'A' };
 inline constexpr CharType pointEnd { 'B' };
-inline constexpr Distance infinite { std::numeric_limits<typename Distance::value_type>::max() };
+template <typename D>
+inline constexpr D infiniteDistance { std::numeric_limits<typename D::value_type>::max() };
+inline constexpr Distance infinite { infiniteDistance<Distance> };
+
+template <typename D>
+[[nodiscard]] constexpr D fromCost(double cost)
+{
+    if constexpr (std::floating_point<typename D::value_type>)
+        return D { cost };
+    else
+        return D { static_cast<typename D::value_type>(cost * static_cast<double>(intDistanceScale) + 0.5) };
+}
+
+// Cost of each move of a connectivity policy, as a D
+template <Connectivity C, typename D>
+inline constexpr auto moveCosts = []<std::size_t... I>(std::index_sequence<I...>) {
+    return std::array<D, sizeof...(I)> { fromCost<D>(C::moves[I].cost)... };
+}(std::make_index_sequence<C::moves.size()> {});
+
+// Mask of the legal moves of a connectivity policy. free(dx, dy) tells
+// whether the cell at the given offset can be entered
+template <Connectivity C, typename Free>
+[[nodiscard]] NeighbourMask movesFrom(Free&& free)
+{
+    NeighbourMask mask {};
+    for (std::size_t i = 0; i < C::moves.size(); ++i) {
+        bool const legal = C::legal(free, C::moves[i].dx, C::moves[i].dy);
+        mask |= static_cast<NeighbourMask>(static_cast<unsigned>(legal) << i);
+    }
+    return mask;
+}
 
 class Graph;
 
@@ -49,22 +95,16 @@ public:
     explicit Vertex(UniqueIdType id, CharType type_, Position const& p);
     friend std::ostream& operator<<(std::ostream& os, Vertex const& v);
     [[nodiscard]] Position const& pos() const;
-    void setDist(Distance const& d);
     void setType(CharType t);
     [[nodiscard]] bool isStart() const;
     [[nodiscard]] bool isEnd() const;
-    [[nodiscard]] bool isShortest() const;
-    [[nodiscard]] bool isValid(Vertex const& v, Graph& graph) const;
+    // One of pointEmpty, pointObstacle, pointStart, pointEnd. What a search
+    // did to the cell is kept by the solver
     [[nodiscard]] CharType type() const;
-    [[nodiscard]] Distance const& dist() const;
-    [[nodiscard]] bool distIsInfinite() const;
     [[nodiscard]] auto operator<=>(Vertex const& v) const = default;
     [[nodiscard]] UniqueIdType id() const;
-    void reset();
 
 private:
-    Distance mDist { infinite };
-    // Needed to insert vertex in a set
     UniqueIdType uniqueId {};
     CharType mType {};
     Position mPos {};
@@ -78,30 +118,181 @@ public:
     }
 };
 
+// A map file parsed once: cell types, shape and endpoints, ready to build a
+// Graph from and to size a window with
+struct MapData {
+    // Row major, row r spans [rowStart[r], rowStart[r + 1])
+    std::vector<CharType> cells {};
+    std::vector<std::size_t> rowStart { 0 };
+    std::optional<std::size_t> start {};
+    // Any number of them, in cell order
+    std::vector<std::size_t> ends {};
+    // Length of the longest row
+    std::size_t width {};
+
+    [[nodiscard]] std::size_t rowCount() const { return rowStart.size() - 1; }
+};
+
+// Throws InvalidGraphException on unknown cell types or a repeated start
+[[nodiscard]] MapData loadMap(std::string_view fname);
+
+// Cell storage and editing. Which moves are legal is decided by the
+// connectivity policy of the derived BasicGraph.
 class Graph {
 public:
     using VertexType = Vertex;
-    inline static constexpr unsigned closests { 8 };
+    using VertexId = Vertex::UniqueIdType;
+
+    Graph() = default;
+    Graph(Graph const&) = default;
+    Graph& operator=(Graph const&) = default;
+    virtual ~Graph() = default;
 
     [[nodiscard]] OptionalPointer<VertexType> vertexPtr(Position const& pos);
-    [[nodiscard]] std::vector<std::reference_wrapper<VertexType>> neighborhoods(VertexType const& v);
+    [[nodiscard]] NeighbourMask moves(VertexType const& v) const;
     [[nodiscard]] std::string stringify() const;
-    [[nodiscard]] std::vector<std::vector<VertexType>>& nodes();
-    [[nodiscard]] std::vector<std::vector<VertexType>> const& nodes() const;
+    // Size in bytes of the textual map, one char per cell and a newline per row
+    [[nodiscard]] std::size_t serializedSize() const;
+    // Passes the textual map to out in consecutive pieces, each filling
+    // buffer at most
+    void serialize(std::span<char> buffer, std::function<void(std::string_view)> const& out) const;
+    [[nodiscard]] std::vector<VertexType>& nodes();
+    [[nodiscard]] std::vector<VertexType> const& nodes() const;
+    [[nodiscard]] std::span<VertexType const> row(std::size_t r) const;
+    [[nodiscard]] std::size_t rowCount() const;
+    // Placing a start clears the previous one, an end is added to the
+    // others. Throws InvalidGraphException unless the type is one of a map
     void markAs(VertexType const& v, CharType);
+    void markAs(VertexId id, CharType);
     void fromFile(std::string_view fname);
+    void fromMap(MapData const& map);
     void buildEmpty(unsigned sizeX, unsigned sizeY);
-    void reset();
-    void updateMaxDistance(Distance newDistance);
-    Distance getMaxDistance() const;
+
+    [[nodiscard]] std::size_t vertexCount() const { return cells.size(); }
+    [[nodiscard]] std::optional<VertexId> startId() const { return start; }
+    [[nodiscard]] std::optional<VertexId> endId() const
+    {
+        return ends.empty() ? std::nullopt : std::optional<VertexId> { ends.front() };
+    }
+    [[nodiscard]] std::span<VertexId const> endIds() const { return ends; }
+    // Kept up to date by markAs, see Clearance
+    [[nodiscard]] Clearance clearance(VertexId id) const { return clearances[static_cast<std::size_t>(id)]; }
+    // Kept up to date by markAs. Cells of different components can't reach
+    // each other
+    [[nodiscard]] ComponentId component(VertexId id) const { return components[static_cast<std::size_t>(id)]; }
+    // Changes whenever the map does. Lets results computed on the graph be
+    // told apart from newer ones
+    [[nodiscard]] std::uint64_t version() const { return mapVersion; }
+
+protected:
+    [[nodiscard]] bool isFree(Position const& pos) const;
+    [[nodiscard]] VertexId idAt(int row, int col) const
+    {
+        return static_cast<VertexId>(rowStart[static_cast<std::size_t>(row)] + static_cast<std::size_t>(col));
+    }
+    virtual void computeMoves() = 0;
+    virtual void updateMoves(Position const& pos) = 0;
+    // Of the connectivity policy, in mask bit order
+    [[nodiscard]] virtual std::span<Move const> moveList() const = 0;
+
+    // Row major, rows may have different lengths. Row r spans [rowStart[r], rowStart[r + 1])
+    std::vector<VertexType> cells {};
+    std::vector<std::size_t> rowStart { 0 };
+    // Indexed by vertex id. Bit i is set when Connectivity::moves[i] is legal.
+    // Kept in sync with obstacles by markAs
+    std::vector<NeighbourMask> moveMask {};
+    // Indexed by vertex id, like moveMask
+    std::vector<Clearance> clearances {};
+    std::vector<ComponentId> components {};
 
 private:
-    std::vector<std::vector<VertexType>> vertex {};
-    Distance maxDistance {};
+    void computeClearance();
+    // Recomputes the square around a toggled cell that can see a change
+    void updateClearance(Position const& pos);
+    // 0 off the map, past the end of a short row included
+    [[nodiscard]] Clearance clearanceAt(std::int64_t row, std::int64_t col) const;
+    void computeComponents();
+    // Joins the components around a cell that was freed, or splits the one
+    // of a cell that was blocked. Only the pieces cut off are relabelled
+    void updateComponents(Position const& pos, bool freed);
+    // Relabels the cells of from reachable from v as to
+    void relabel(VertexId v, ComponentId from, ComponentId to);
+    [[nodiscard]] ComponentId newComponent();
+    template <typename F>
+    void forEachMove(VertexId id, F&& f) const;
+
+    std::optional<VertexId> start {};
+    std::vector<VertexId> ends {};
+    std::uint64_t mapVersion {};
+    // Cells per component, 0 for the labels in spareComponents
+    std::vector<std::size_t> componentSizes {};
+    std::vector<ComponentId> spareComponents {};
 };
 
+template <Connectivity C, typename D = Distance>
+class BasicGraph : public Graph {
+public:
+    using ConnectivityType = C;
+    using DistanceType = D;
+    inline static constexpr std::size_t closests { C::moves.size() };
+
+    template <typename F>
+    void forEachNeighbour(VertexId id, F&& f) const
+    {
+        auto const& pos = cells[static_cast<std::size_t>(id)].pos();
+        auto const mask = moveMask[static_cast<std::size_t>(id)];
+        // Unrolled over the moves of the policy
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            ((mask & (1u << I)
+                    ? (void)f(idAt(pos.x.value() + C::moves[I].dx, pos.y.value() + C::moves[I].dy), cost[I])
+                    : void()),
+                ...);
+        }(std::make_index_sequence<closests> {});
+    }
+
+    // Only the moves to a cell with at least need[i] clearance, for the i-th
+    // move of the policy. See AgentView
+    template <typename F>
+    void forEachNeighbour(VertexId id, std::array<Clearance, closests> const& need, F&& f) const
+    {
+        auto const& pos = cells[static_cast<std::size_t>(id)].pos();
+        auto const mask = moveMask[static_cast<std::size_t>(id)];
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            ((mask & (1u << I)
+                    ? [&] {
+                          auto const n = idAt(pos.x.value() + C::moves[I].dx, pos.y.value() + C::moves[I].dy);
+                          if (clearances[static_cast<std::size_t>(n)] >= need[I])
+                              f(n, cost[I]);
+                      }()
+                    : void()),
+                ...);
+        }(std::make_index_sequence<closests> {});
+    }
+
+protected:
+    void computeMoves() override;
+    void updateMoves(Position const& pos) override;
+    [[nodiscard]] std::span<Move const> moveList() const override { return C::moves; }
+
+private:
+    inline static constexpr auto cost = moveCosts<C, D>;
+};
+
+extern template class BasicGraph<FourConnected>;
+extern template class BasicGraph<EightConnected>;
+extern template class BasicGraph<CornerCutting>;
+extern template class BasicGraph<FourConnected, IntDistance>;
+extern template class BasicGraph<EightConnected, IntDistance>;
+extern template class BasicGraph<CornerCutting, IntDistance>;
+
 std::ostream& operator<<(std::ostream& os, Graph const& lvl);
 std::ostream& operator<<(std::ostream& os, Graph::VertexType const& v);
-void writeGraph(std::string_view fname, Graph const& graph);
+enum class WriteMode {
+    BUFFERED,
+    // Falls back to BUFFERED where memory mapped files are not available
+    MAPPED,
+};
+
+void writeGraph(std::string_view fname, Graph const& graph, WriteMode mode = WriteMode::BUFFERED);
 }
 #endif
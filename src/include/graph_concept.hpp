@@ -0,0 +1,61 @@
+#ifndef GRAPH_CONCEPT_HPP
+#define GRAPH_CONCEPT_HPP
+
+#include "csr_graph.hpp"
+#include "graph.hpp"
+#include <concepts>
+#include <cstddef>
+#include <span>
+
+namespace gr {
+
+namespace detail {
+    template <typename Id, typename D>
+    struct NeighbourSink {
+        void operator()(Id, D) const { }
+    };
+}
+
+// What a solver needs from a graph: dense integral vertex ids in
+// [0, vertexCount()) and a way to visit the weighted out-edges of a vertex.
+template <typename G>
+concept SearchGraph = requires(G const& g, typename G::VertexId v) {
+    requires std::integral<typename G::VertexId>;
+    typename G::DistanceType;
+    { g.vertexCount() } -> std::convertible_to<std::size_t>;
+    g.forEachNeighbour(v, detail::NeighbourSink<typename G::VertexId, typename G::DistanceType> {});
+};
+
+// Graphs that know their own endpoints
+template <typename G>
+concept EndpointGraph = SearchGraph<G> && requires(G const& g) {
+    { g.startId() } -> std::same_as<std::optional<typename G::VertexId>>;
+    { g.endId() } -> std::same_as<std::optional<typename G::VertexId>>;
+};
+
+// Endpoint graphs with any number of ends, endId() being the first of them
+template <typename G>
+concept MultiGoalGraph = EndpointGraph<G> && requires(G const& g) {
+    { g.endIds() } -> std::convertible_to<std::span<typename G::VertexId const>>;
+};
+
+// Graphs that label their connected components, so that a search between
+// two of them can be given up before it starts
+template <typename G>
+concept ComponentGraph = SearchGraph<G> && requires(G const& g, typename G::VertexId v) {
+    { g.component(v) } -> std::same_as<ComponentId>;
+};
+
+// Graphs too large to give every vertex a slot of solver state. The solver
+// keeps state only for the vertices it reaches
+template <typename G>
+concept SparseGraph = SearchGraph<G> && G::sparseState;
+
+static_assert(SearchGraph<BasicGraph<EightConnected>>);
+static_assert(EndpointGraph<BasicGraph<EightConnected>>);
+static_assert(MultiGoalGraph<BasicGraph<EightConnected>>);
+static_assert(ComponentGraph<BasicGraph<EightConnected>>);
+static_assert(SearchGraph<CsrGraph>);
+}
+
+#endif
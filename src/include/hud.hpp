@@ -0,0 +1,50 @@
+#ifndef HUD_HPP
+#define HUD_HPP
+
+#include "SFML/Graphics.hpp"
+#include "settings.hpp"
+#include <array>
+#include <cstddef>
+#include <string>
+
+// Frame timing overlay, toggled at runtime. The last frames are drawn as
+// stacked bars, one per frame, split into event polling, solving and
+// drawing. The figures themselves go to the window title, there is no font
+// to draw them with.
+class Hud {
+public:
+    // In milliseconds
+    struct Frame {
+        float poll {};
+        float solve {};
+        float draw {};
+    };
+
+    explicit Hud(std::string title_);
+
+    void toggle(sf::RenderWindow& window);
+    [[nodiscard]] bool visible() const { return shown; }
+
+    // expansions is the total of the current search, open the vertices it
+    // has waiting
+    void record(Frame const& frame, std::size_t expansions, std::size_t open);
+    void draw(sf::RenderWindow& window, WindowSize const& size);
+
+private:
+    inline static constexpr std::size_t historySize { 120 };
+
+    void updateTitle(sf::RenderWindow& window);
+
+    std::string title {};
+    bool shown {};
+    std::array<Frame, historySize> history {};
+    // Where the next frame goes, the oldest one once the history is full
+    std::size_t next {};
+    std::size_t openSize {};
+    std::size_t lastExpansions {};
+    // Since the title was last updated
+    std::size_t newExpansions {};
+    sf::Clock titleClock {};
+};
+
+#endif
@@ -5,6 +5,7 @@
 #include <fstream>
 #include <iterator>
 #include <map>
+#include <span>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -51,6 +52,11 @@ public:
 
     std::string readline();
 
+    // Unformatted access, for binary files
+    void read(char* dst, std::size_t count);
+
+    void seek(std::streamoff pos);
+
     [[nodiscard]] std::ios_base::iostate state() const;
 
     [[nodiscard]] bool stateok() const;
@@ -93,6 +99,24 @@ public:
 private:
     std::fstream stream;
 };
+
+// A file of a given size mapped in memory for writing. Only available where
+// mmap is, see mappedFilesAvailable
+class MappedFile {
+public:
+    MappedFile(std::string_view fname, std::size_t size);
+    MappedFile(MappedFile const&) = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+    ~MappedFile();
+
+    [[nodiscard]] std::span<char> data() { return { mData, mSize }; }
+
+private:
+    char* mData { nullptr };
+    std::size_t mSize {};
+};
+
+extern bool const mappedFilesAvailable;
 }
 
 #endif
@@ -0,0 +1,276 @@
+#ifndef LANDMARKS_HPP
+#define LANDMARKS_HPP
+
+#include "dijkstra.hpp"
+#include "graph.hpp"
+#include "graph_concept.hpp"
+#include "io.hpp"
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace gr {
+
+class InvalidLandmarkFileException : std::exception {
+public:
+    const char* what() const noexcept override
+    {
+        return "Invalid landmark file";
+    }
+};
+
+// On disk a landmark table is a LandmarkHeader, the landmark ids as
+// uint64 and the distances, landmarks of a vertex next to each other
+struct LandmarkHeader {
+    char magic[8] { 'D', 'J', 'K', 'L', 'M', 'R', 'K', '1' };
+    std::uint64_t vertices {};
+    std::uint64_t landmarks {};
+    // Of a stored distance, 4 for floats or integers
+    std::uint64_t valueSize {};
+};
+
+// Distances from a few landmarks to every vertex, for ALT searches. By the
+// triangle inequality |d(L, t) - d(L, v)| never exceeds d(v, t), which holds
+// for graphs whose edges go both ways, like the grids. Distances are stored
+// in 4 bytes: floats rounded down for floating point distances, integers
+// for integral ones. Vertices a landmark does not reach, or whose distance
+// does not fit, give no bound from it.
+template <typename D, typename Id>
+class LandmarkTable {
+public:
+    using Stored = std::conditional_t<std::floating_point<typename D::value_type>, float, std::uint32_t>;
+    inline static constexpr Stored unknown { std::numeric_limits<Stored>::max() };
+
+    LandmarkTable() = default;
+
+    // Searches from each of landmarks in turn
+    template <SearchGraph G>
+        requires(!SparseGraph<G>) && std::same_as<typename G::DistanceType, D> && std::same_as<typename G::VertexId, Id>
+    static LandmarkTable at(G const& g, std::span<Id const> landmarks);
+    // Farthest point selection: the first landmark is the vertex farthest
+    // from seed, each next one the vertex farthest from those chosen so far.
+    // Only the part of the graph reachable from seed gets landmarks
+    template <SearchGraph G>
+        requires(!SparseGraph<G>) && std::same_as<typename G::DistanceType, D> && std::same_as<typename G::VertexId, Id>
+    static LandmarkTable farthest(G const& g, Id seed, std::size_t count);
+    // Throws unless the table was built for a graph of this many vertices
+    static LandmarkTable load(std::string_view fname, std::size_t vertexCount);
+    void save(std::string_view fname) const;
+
+    [[nodiscard]] std::span<Id const> landmarks() const { return marks; }
+    [[nodiscard]] std::size_t vertexCount() const { return vertices; }
+    // The distance of v from each landmark
+    [[nodiscard]] std::span<Stored const> row(Id v) const
+    {
+        return { table.data() + static_cast<std::size_t>(v) * marks.size(), marks.size() };
+    }
+
+    // A lower bound on the distance from the vertex of row to the vertex of
+    // other
+    [[nodiscard]] static D bound(std::span<Stored const> row, std::span<Stored const> other)
+    {
+        typename D::value_type best { 0 };
+        for (std::size_t i = 0; i < row.size(); ++i) {
+            auto const a = row[i];
+            auto const b = other[i];
+            if (a == unknown || b == unknown)
+                continue;
+            if constexpr (std::floating_point<Stored>) {
+                // Both were rounded down by less than an ulp
+                auto const hi = std::max(a, b);
+                auto const diff = static_cast<double>(hi) - static_cast<double>(std::min(a, b)) - static_cast<double>(hi) * 0x1p-21;
+                best = std::max(best, static_cast<typename D::value_type>(diff));
+            } else {
+                best = std::max<typename D::value_type>(best, a > b ? a - b : b - a);
+            }
+        }
+        return D { best };
+    }
+
+private:
+    [[nodiscard]] static Stored compact(D d)
+    {
+        if (d == infiniteDistance<D>)
+            return unknown;
+        if constexpr (std::floating_point<Stored>) {
+            if (d.value() >= static_cast<typename D::value_type>(std::numeric_limits<Stored>::max()))
+                return unknown;
+            auto const f = static_cast<float>(d.value());
+            return f > d.value() ? std::nextafter(f, 0.f) : f;
+        } else {
+            return d.value() >= unknown ? unknown : static_cast<Stored>(d.value());
+        }
+    }
+
+    // One column per landmark, interleaved into table
+    void build(std::size_t vertexCount, std::vector<std::vector<Stored>> const& columns);
+
+    std::size_t vertices {};
+    std::vector<Id> marks {};
+    std::vector<Stored> table {};
+};
+
+// ALT heuristic: the best landmark bound to the nearest of the targets
+template <typename D, typename Id>
+class LandmarkHeuristic {
+public:
+    LandmarkHeuristic() = default;
+    explicit LandmarkHeuristic(LandmarkTable<D, Id> const& table_)
+        : table { &table_ }
+    {
+    }
+
+    // Copies the rows of the targets, reusing the memory of the last ones
+    void aim(std::span<Id const> targets)
+    {
+        rows.clear();
+        if (table == nullptr || table->landmarks().empty())
+            return;
+        for (auto t : targets) {
+            auto const r = table->row(t);
+            rows.insert(rows.end(), r.begin(), r.end());
+        }
+    }
+
+    [[nodiscard]] D operator()(Id v) const
+    {
+        if (rows.empty())
+            return D { 0 };
+        auto const width = table->landmarks().size();
+        auto const own = table->row(v);
+        auto best = infiniteDistance<D>;
+        for (std::size_t i = 0; i < rows.size(); i += width)
+            best = std::min(best, LandmarkTable<D, Id>::bound(own, { rows.data() + i, width }));
+        return best;
+    }
+
+private:
+    LandmarkTable<D, Id> const* table { nullptr };
+    std::vector<typename LandmarkTable<D, Id>::Stored> rows {};
+};
+
+template <typename G, typename Open = SetOpenList<typename G::DistanceType, typename G::VertexId>>
+using AltDijkstra = BasicDijkstra<G, Open, LandmarkHeuristic<typename G::DistanceType, typename G::VertexId>>;
+
+template <typename D, typename Id>
+template <SearchGraph G>
+    requires(!SparseGraph<G>) && std::same_as<typename G::DistanceType, D> && std::same_as<typename G::VertexId, Id>
+LandmarkTable<D, Id> LandmarkTable<D, Id>::at(G const& g, std::span<Id const> landmarks)
+{
+    BasicDijkstra<G const> djk {};
+    std::vector<std::vector<Stored>> columns {};
+    for (auto l : landmarks) {
+        djk.loadGraph(g, l);
+        djk.run();
+        auto& column = columns.emplace_back(g.vertexCount());
+        for (std::size_t v = 0; v < column.size(); ++v)
+            column[v] = compact(djk.distance(static_cast<Id>(v)));
+    }
+    LandmarkTable result {};
+    result.marks.assign(landmarks.begin(), landmarks.end());
+    result.build(g.vertexCount(), columns);
+    return result;
+}
+
+template <typename D, typename Id>
+template <SearchGraph G>
+    requires(!SparseGraph<G>) && std::same_as<typename G::DistanceType, D> && std::same_as<typename G::VertexId, Id>
+LandmarkTable<D, Id> LandmarkTable<D, Id>::farthest(G const& g, Id seed, std::size_t count)
+{
+    BasicDijkstra<G const> djk {};
+    std::vector<std::vector<Stored>> columns {};
+    LandmarkTable result {};
+    // Distance of every vertex from the nearest landmark so far
+    std::vector<D> nearest(g.vertexCount(), infiniteDistance<D>);
+    djk.loadGraph(g, seed);
+    djk.run();
+    for (std::size_t v = 0; v < nearest.size(); ++v)
+        nearest[v] = djk.distance(static_cast<Id>(v));
+
+    while (result.marks.size() < count) {
+        std::size_t next { nearest.size() };
+        for (std::size_t v = 0; v < nearest.size(); ++v) {
+            if (nearest[v] != infiniteDistance<D> && (next == nearest.size() || nearest[next] < nearest[v]))
+                next = v;
+        }
+        // Every reachable vertex is a landmark already
+        if (next == nearest.size() || (!result.marks.empty() && nearest[next] == D { 0 }))
+            break;
+
+        auto const landmark = static_cast<Id>(next);
+        djk.loadGraph(g, landmark);
+        djk.run();
+        auto& column = columns.emplace_back(g.vertexCount());
+        for (std::size_t v = 0; v < column.size(); ++v) {
+            auto const d = djk.distance(static_cast<Id>(v));
+            column[v] = compact(d);
+            // The first landmark restarts the distances, which were from seed
+            if (result.marks.empty() || d < nearest[v])
+                nearest[v] = d;
+        }
+        result.marks.push_back(landmark);
+    }
+    result.build(g.vertexCount(), columns);
+    return result;
+}
+
+template <typename D, typename Id>
+void LandmarkTable<D, Id>::build(std::size_t vertexCount, std::vector<std::vector<Stored>> const& columns)
+{
+    vertices = vertexCount;
+    table.resize(vertices * columns.size());
+    for (std::size_t v = 0; v < vertices; ++v)
+        for (std::size_t i = 0; i < columns.size(); ++i)
+            table[v * columns.size() + i] = columns[i][v];
+}
+
+template <typename D, typename Id>
+LandmarkTable<D, Id> LandmarkTable<D, Id>::load(std::string_view fname, std::size_t vertexCount)
+{
+    io::File in { fname, io::in | io::bin };
+    LandmarkHeader head {};
+    in.read(reinterpret_cast<char*>(&head), sizeof(head));
+    if (std::memcmp(head.magic, LandmarkHeader {}.magic, sizeof(head.magic)) != 0
+        || head.valueSize != sizeof(Stored) || head.vertices != vertexCount || head.landmarks > vertexCount)
+        throw InvalidLandmarkFileException {};
+
+    LandmarkTable result {};
+    result.vertices = vertexCount;
+    std::vector<std::uint64_t> ids(head.landmarks);
+    in.read(reinterpret_cast<char*>(ids.data()), ids.size() * sizeof(std::uint64_t));
+    for (auto id : ids) {
+        if (id >= vertexCount)
+            throw InvalidLandmarkFileException {};
+        result.marks.push_back(static_cast<Id>(id));
+    }
+    result.table.resize(head.vertices * head.landmarks);
+    in.read(reinterpret_cast<char*>(result.table.data()), result.table.size() * sizeof(Stored));
+    return result;
+}
+
+template <typename D, typename Id>
+void LandmarkTable<D, Id>::save(std::string_view fname) const
+{
+    io::File out { fname, io::out | io::bin };
+    LandmarkHeader head {};
+    head.vertices = vertexCount();
+    head.landmarks = marks.size();
+    head.valueSize = sizeof(Stored);
+    out.write({ reinterpret_cast<char const*>(&head), sizeof(head) });
+    std::vector<std::uint64_t> const ids(marks.begin(), marks.end());
+    out.write({ reinterpret_cast<char const*>(ids.data()), ids.size() * sizeof(std::uint64_t) });
+    out.write({ reinterpret_cast<char const*>(table.data()), table.size() * sizeof(Stored) });
+}
+
+}
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef MAP_LOADER_HPP
+#define MAP_LOADER_HPP
+
+#include "graph.hpp"
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace gr {
+
+struct MapShape {
+    std::size_t rows {};
+    std::size_t cols {};
+};
+
+// A first guess at the shape of an ASCII map, from its first line and the
+// size of the file, in constant time. Exact for rectangular maps only: the
+// rows polled from a MapLoader give the true one
+[[nodiscard]] MapShape peekMapShape(std::string_view fname);
+
+// Reads an ASCII map on a thread of its own, a band of rows at a time, so
+// that the rows read so far can be shown meanwhile. Once the whole map is
+// read then(map) runs on that thread too, to build from it without
+// blocking the caller. Destroying the loader stops it after the band it is
+// reading.
+class MapLoader {
+public:
+    MapLoader(std::string fname, std::function<void(MapData const&)> then);
+
+    // Appends the rows read since the last call to rows, whose rowCount()
+    // and width then give the shape read so far. Returns true once the map
+    // is read and then has returned, rows then being the whole map.
+    // Rethrows what either threw, InvalidGraphException on a bad map
+    [[nodiscard]] bool poll(MapData& rows);
+
+private:
+    void load(std::stop_token stop, std::string const& fname, std::function<void(MapData const&)> const& then);
+
+    std::mutex mutex {};
+    // Read but not polled yet
+    MapData pending {};
+    bool finished {};
+    std::exception_ptr error {};
+    // Last, so that it is stopped before the rest goes
+    std::jthread worker;
+};
+
+}
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef MAP_PARSER_HPP
+#define MAP_PARSER_HPP
+
+#include "graph.hpp"
+#include <string_view>
+
+namespace gr {
+
+// Parses the text of an ASCII map, the way loadMap reads its file. Cells are
+// classified a SIMD block at a time and row ranges are split across threads,
+// 0 picks one per hardware thread. Throws InvalidGraphException on unknown
+// cell types or a repeated start
+[[nodiscard]] MapData parseMap(std::string_view text, unsigned threads = 0);
+
+}
+
+#endif
@@ -0,0 +1,174 @@
+#ifndef MAP_SNAPSHOT_HPP
+#define MAP_SNAPSHOT_HPP
+
+#include "clearance.hpp"
+#include "connectivity.hpp"
+#include "graph.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace gr {
+
+struct CellEdit {
+    std::size_t row {};
+    std::size_t col {};
+    // One of pointEmpty, pointObstacle, pointStart, pointEnd
+    CharType type {};
+};
+
+// An immutable version of a map, safe to search from any number of threads.
+// Rows are stored in chunks of chunkRows rows shared between versions: an
+// edit copies only the chunks it touches. Ragged rows are padded with
+// obstacles up to the longest one.
+template <Connectivity C, typename D = Distance>
+class MapSnapshot {
+public:
+    using VertexId = std::uint64_t;
+    using DistanceType = D;
+    using ConnectivityType = C;
+    inline static constexpr std::size_t chunkRows { 64 };
+    inline static constexpr std::size_t closests { C::moves.size() };
+
+    explicit MapSnapshot(MapData const& map);
+
+    // The next version, with edits applied in order. Placing a start clears
+    // the previous one, an end is added to the others. Throws InvalidGraphException for cells
+    // out of the map or types other than the four above
+    [[nodiscard]] std::shared_ptr<MapSnapshot const> edited(std::span<CellEdit const> edits) const;
+
+    [[nodiscard]] std::uint64_t version() const { return number; }
+    [[nodiscard]] std::size_t rows() const { return rowCount; }
+    [[nodiscard]] std::size_t cols() const { return colCount; }
+    [[nodiscard]] std::size_t vertexCount() const { return rowCount * colCount; }
+    [[nodiscard]] std::optional<VertexId> startId() const { return start; }
+    [[nodiscard]] std::optional<VertexId> endId() const
+    {
+        return ends.empty() ? std::nullopt : std::optional<VertexId> { ends.front() };
+    }
+    [[nodiscard]] std::span<VertexId const> endIds() const { return ends; }
+    [[nodiscard]] CharType type(VertexId id) const
+    {
+        auto const [chunk, offset] = locate(id);
+        return chunks[chunk]->types[offset];
+    }
+    [[nodiscard]] Clearance clearance(VertexId id) const
+    {
+        auto const [chunk, offset] = locate(id);
+        return chunks[chunk]->clearances[offset];
+    }
+
+    template <typename F>
+    void forEachNeighbour(VertexId id, F&& f) const
+    {
+        auto const [chunk, offset] = locate(id);
+        auto const mask = chunks[chunk]->masks[offset];
+        auto const stride = static_cast<std::int64_t>(colCount);
+        // Unrolled over the moves of the policy
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            ((mask & (1u << I)
+                    ? (void)f(static_cast<VertexId>(static_cast<std::int64_t>(id) + C::moves[I].dx * stride + C::moves[I].dy), cost[I])
+                    : void()),
+                ...);
+        }(std::make_index_sequence<closests> {});
+    }
+
+    // Only the moves to a cell with at least need[i] clearance, for the i-th
+    // move of the policy. See AgentView
+    template <typename F>
+    void forEachNeighbour(VertexId id, std::array<Clearance, closests> const& need, F&& f) const
+    {
+        auto const [chunk, offset] = locate(id);
+        auto const mask = chunks[chunk]->masks[offset];
+        auto const stride = static_cast<std::int64_t>(colCount);
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            ((mask & (1u << I)
+                    ? [&] {
+                          auto const n = static_cast<VertexId>(static_cast<std::int64_t>(id) + C::moves[I].dx * stride + C::moves[I].dy);
+                          if (clearance(n) >= need[I])
+                              f(n, cost[I]);
+                      }()
+                    : void()),
+                ...);
+        }(std::make_index_sequence<closests> {});
+    }
+
+private:
+    struct Chunk {
+        std::vector<CharType> types {};
+        std::vector<NeighbourMask> masks {};
+        std::vector<Clearance> clearances {};
+    };
+
+    MapSnapshot(MapSnapshot const&) = default;
+
+    [[nodiscard]] std::pair<std::size_t, std::size_t> locate(VertexId id) const
+    {
+        auto const chunk = static_cast<std::size_t>(id) / (chunkRows * colCount);
+        return { chunk, static_cast<std::size_t>(id) - chunk * chunkRows * colCount };
+    }
+    [[nodiscard]] bool isFree(std::int64_t row, std::int64_t col) const;
+    [[nodiscard]] NeighbourMask movesAt(std::int64_t row, std::int64_t col) const;
+    // 0 off the map
+    [[nodiscard]] Clearance clearanceAt(std::int64_t row, std::int64_t col) const;
+
+    inline static constexpr auto cost = moveCosts<C, D>;
+
+    // Never written once shared with another snapshot
+    std::vector<std::shared_ptr<Chunk>> chunks {};
+    std::size_t rowCount {};
+    std::size_t colCount {};
+    std::optional<VertexId> start {};
+    std::vector<VertexId> ends {};
+    std::uint64_t number {};
+};
+
+// The current version of a map. Readers take the latest snapshot and keep
+// it for as long as they need, writers publish a new one atomically.
+// Neither waits for the other.
+template <Connectivity C, typename D = Distance>
+class VersionedMap {
+public:
+    using Snapshot = MapSnapshot<C, D>;
+
+    explicit VersionedMap(MapData const& map)
+        : head { std::make_shared<Snapshot const>(map) }
+    {
+    }
+
+    [[nodiscard]] std::shared_ptr<Snapshot const> snapshot() const
+    {
+        return head.load(std::memory_order_acquire);
+    }
+
+    // Rebuilt on the newer version when another writer published first, so
+    // that no edit is lost. Returns the version published
+    std::shared_ptr<Snapshot const> edit(std::span<CellEdit const> edits)
+    {
+        auto current = snapshot();
+        for (;;) {
+            auto next = current->edited(edits);
+            if (head.compare_exchange_weak(current, next, std::memory_order_acq_rel, std::memory_order_acquire))
+                return next;
+        }
+    }
+
+private:
+    std::atomic<std::shared_ptr<Snapshot const>> head;
+};
+
+extern template class MapSnapshot<FourConnected>;
+extern template class MapSnapshot<EightConnected>;
+extern template class MapSnapshot<CornerCutting>;
+extern template class MapSnapshot<FourConnected, IntDistance>;
+extern template class MapSnapshot<EightConnected, IntDistance>;
+extern template class MapSnapshot<CornerCutting, IntDistance>;
+}
+
+#endif
@@ -12,7 +12,7 @@ struct MousePos {
 
 class MouseEventHandler {
 public:
-    void handleEvent(sf::Event const& event, gr::Vertex& ver);
+    void handleEvent(sf::Event const& event, gr::Vertex& ver, gr::Graph& graph);
 
 private:
     enum class State {
@@ -20,9 +20,9 @@ private:
         GRABBED_END,
         FREE,
     };
-    void handleButtonEvent(sf::Event const& event, gr::Vertex& ver);
+    void handleButtonEvent(sf::Event const& event, gr::Vertex& ver, gr::Graph& graph);
 
-    void handleMoveEvent(sf::Event const& event, gr::Vertex& ver);
+    void handleMoveEvent(sf::Event const& event, gr::Vertex& ver, gr::Graph& graph);
 
     State state { State::FREE };
     gr::Vertex* v { nullptr };
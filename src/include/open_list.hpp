@@ -0,0 +1,130 @@
+#ifndef OPEN_LIST_HPP
+#define OPEN_LIST_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <limits>
+#include <memory_resource>
+#include <set>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Priority queues of (distance, vertex) pairs for the solvers. decrease()
+// may either update the entry in place or push a duplicate: the solver
+// drops popped entries whose distance is stale.
+// They allocate from the memory resource they are built with.
+template <typename L, typename D, typename Id>
+concept OpenList = std::constructible_from<L, std::pmr::memory_resource*> && requires(L& l, D d, Id v) {
+    { l.empty() } -> std::same_as<bool>;
+    { l.size() } -> std::convertible_to<std::size_t>;
+    l.push(d, v);
+    l.decrease(d, d, v);
+    { l.pop() } -> std::same_as<std::pair<D, Id>>;
+    l.clear();
+};
+
+// Comparison based, works with any distance type
+template <typename D, typename Id>
+class SetOpenList {
+public:
+    explicit SetOpenList(std::pmr::memory_resource* resource)
+        : entries { resource }
+    {
+    }
+
+    [[nodiscard]] bool empty() const { return entries.empty(); }
+    [[nodiscard]] std::size_t size() const { return entries.size(); }
+    void push(D d, Id v) { entries.emplace(d, v); }
+    void decrease(D oldDist, D newDist, Id v)
+    {
+        entries.erase({ oldDist, v });
+        entries.emplace(newDist, v);
+    }
+    [[nodiscard]] std::pair<D, Id> pop() { return entries.extract(entries.begin()).value(); }
+    void clear() { entries.clear(); }
+
+private:
+    std::pmr::set<std::pair<D, Id>> entries;
+};
+
+// Monotone radix heap for unsigned integer distances. Popped keys never
+// decrease, so an entry only needs to move to a lower bucket when the last
+// popped key changes: each entry moves at most once per bit of the key.
+template <typename D, typename Id>
+    requires std::unsigned_integral<typename D::value_type>
+class RadixHeap {
+public:
+    using Key = typename D::value_type;
+
+    explicit RadixHeap(std::pmr::memory_resource* resource)
+        : buckets { [&]<std::size_t... I>(std::index_sequence<I...>) {
+            return Buckets { ((void)I, Bucket { resource })... };
+        }(std::make_index_sequence<bits + 1> {}) }
+    {
+    }
+
+    [[nodiscard]] bool empty() const { return count == 0; }
+    // Stale entries included, an upper bound on the vertices waiting
+    [[nodiscard]] std::size_t size() const { return count; }
+
+    void push(D d, Id v)
+    {
+        buckets[bucketOf(d.value())].emplace_back(d.value(), v);
+        count += 1;
+    }
+
+    // Entries cannot be removed, the old one becomes stale
+    void decrease(D, D newDist, Id v) { push(newDist, v); }
+
+    [[nodiscard]] std::pair<D, Id> pop()
+    {
+        if (buckets[0].empty())
+            refill();
+        auto const [key, v] = buckets[0].back();
+        buckets[0].pop_back();
+        count -= 1;
+        return { D { key }, v };
+    }
+
+    void clear()
+    {
+        for (auto& bucket : buckets)
+            bucket.clear();
+        last = 0;
+        count = 0;
+    }
+
+private:
+    inline static constexpr std::size_t bits { std::numeric_limits<Key>::digits };
+
+    [[nodiscard]] std::size_t bucketOf(Key key) const
+    {
+        return static_cast<std::size_t>(std::bit_width(key ^ last));
+    }
+
+    // Moves the first non empty bucket down, relative to its minimum
+    void refill()
+    {
+        std::size_t i { 1 };
+        while (buckets[i].empty())
+            ++i;
+        auto& bucket = buckets[i];
+        last = std::ranges::min_element(bucket, {}, &std::pair<Key, Id>::first)->first;
+        for (auto const& entry : bucket)
+            buckets[bucketOf(entry.first)].push_back(entry);
+        bucket.clear();
+    }
+
+    using Bucket = std::pmr::vector<std::pair<Key, Id>>;
+    using Buckets = std::array<Bucket, bits + 1>;
+
+    Buckets buckets;
+    Key last {};
+    std::size_t count {};
+};
+
+#endif
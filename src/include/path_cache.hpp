@@ -0,0 +1,124 @@
+#ifndef PATH_CACHE_HPP
+#define PATH_CACHE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Results of past queries, keyed by the map version they ran on, their
+// endpoints and their options. Entries of older map versions never match
+// and are dropped as soon as a newer version is seen. Each shard keeps its
+// least recently used entries, up to its share of the capacity, behind its
+// own mutex, so that concurrent queries seldom wait on each other.
+template <typename Value>
+class PathCache {
+public:
+    struct Key {
+        std::uint64_t version {};
+        std::uint64_t source {};
+        std::uint64_t target {};
+        // Anything else that changes the result, in a canonical form
+        std::string options {};
+
+        bool operator==(Key const&) const = default;
+    };
+
+    explicit PathCache(std::size_t capacity, std::size_t shardCount = 16)
+        : shards(std::max<std::size_t>(std::min(shardCount, capacity), 1))
+        , perShard { (capacity + shards.size() - 1) / shards.size() }
+    {
+    }
+
+    // Shared, so that no value is copied while a shard is locked
+    [[nodiscard]] std::shared_ptr<Value const> find(Key const& key)
+    {
+        auto& shard = shardOf(key);
+        std::scoped_lock lock { shard.mutex };
+        shard.advance(key.version);
+        auto it = shard.entries.find(key);
+        if (it == shard.entries.end()) {
+            misses.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        shard.uses.splice(shard.uses.begin(), shard.uses, it->second.use);
+        hits.fetch_add(1, std::memory_order_relaxed);
+        return it->second.value;
+    }
+
+    // Results of a version older than the newest one seen are not kept
+    void insert(Key key, std::shared_ptr<Value const> value)
+    {
+        if (perShard == 0)
+            return;
+        auto& shard = shardOf(key);
+        std::scoped_lock lock { shard.mutex };
+        shard.advance(key.version);
+        if (key.version < shard.latest)
+            return;
+        if (auto it = shard.entries.find(key); it != shard.entries.end()) {
+            it->second.value = std::move(value);
+            return;
+        }
+        if (shard.entries.size() >= perShard) {
+            shard.entries.erase(shard.uses.back());
+            shard.uses.pop_back();
+        }
+        shard.uses.push_front(key);
+        shard.entries.emplace(std::move(key), Entry { std::move(value), shard.uses.begin() });
+    }
+
+    [[nodiscard]] std::size_t hitCount() const { return hits.load(std::memory_order_relaxed); }
+    [[nodiscard]] std::size_t missCount() const { return misses.load(std::memory_order_relaxed); }
+
+private:
+    struct KeyHash {
+        std::size_t operator()(Key const& k) const
+        {
+            auto h = std::hash<std::string> {}(k.options);
+            for (auto v : { k.version, k.source, k.target })
+                h = (h ^ std::hash<std::uint64_t> {}(v)) * 0x100000001b3ull;
+            return h;
+        }
+    };
+
+    struct Entry {
+        std::shared_ptr<Value const> value {};
+        typename std::list<Key>::iterator use {};
+    };
+
+    struct Shard {
+        // Drops everything once the map has moved on
+        void advance(std::uint64_t version)
+        {
+            if (version <= latest)
+                return;
+            latest = version;
+            entries.clear();
+            uses.clear();
+        }
+
+        std::mutex mutex {};
+        std::uint64_t latest {};
+        // Most recently used first
+        std::list<Key> uses {};
+        std::unordered_map<Key, Entry, KeyHash> entries {};
+    };
+
+    Shard& shardOf(Key const& key) { return shards[KeyHash {}(key) % shards.size()]; }
+
+    std::vector<Shard> shards;
+    std::size_t perShard {};
+    std::atomic<std::size_t> hits {};
+    std::atomic<std::size_t> misses {};
+};
+
+#endif
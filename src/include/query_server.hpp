@@ -0,0 +1,68 @@
+#ifndef QUERY_SERVER_HPP
+#define QUERY_SERVER_HPP
+
+#include "connectivity.hpp"
+#include "graph.hpp"
+#include <cstddef>
+#include <exception>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+class ServerException : std::exception {
+public:
+    const char* what() const noexcept override
+    {
+        return "Query server socket error";
+    }
+};
+
+// Answers path queries on a map loaded once. A query is one line
+//     row col row col [path] [size n] [maxcost c] [maxexp n] [timeout ms]
+// giving the start and end cells, the side of the square agent that moves
+// (1 by default, centred on its cell, see Clearance) and optional limits on
+// the search. The answer is one line too:
+//     <cost> <expansions> [row,col ...]   when the end was reached
+//     none <expansions>                   when it cannot be
+//     cutoff <limit> <expansions> <bound> <cost> [row,col ...]
+//                                         when a limit stopped the search,
+//                                         the end being at least bound away.
+//                                         The path, if asked for, leads to
+//                                         the cell the search got closest
+//                                         to the end at, cost away
+//     error <reason>                      for a malformed query
+// The map is edited with
+//     set row col type
+// where type is one of * X A B, answered with the new map version. A query
+// runs on the version current when it starts. Answers are cached per map
+// version,
+//     stats
+// answers cache <hits> <misses>.
+class QueryServer {
+public:
+    // The solver of one connection
+    class Session {
+    public:
+        virtual ~Session() = default;
+        // Without the trailing newline
+        [[nodiscard]] virtual std::string answer(std::string_view query) = 0;
+    };
+
+    // Up to cacheSize answers are kept, 0 disables the cache
+    static std::unique_ptr<QueryServer> make(gr::MapData const& map, gr::ConnectivityMode mode, std::size_t cacheSize = 1024);
+    virtual ~QueryServer() = default;
+
+    // Sessions may run on different threads
+    [[nodiscard]] virtual std::unique_ptr<Session> session() = 0;
+
+    // Answers every line read from in on out, until in is closed
+    void serve(std::istream& in, std::ostream& out);
+    // Serves the connections to a Unix domain socket, each on its own
+    // thread, forever. Throws ServerException when the socket cannot be set up or
+    // where Unix domain sockets are not available
+    void listen(std::string_view socketPath);
+};
+
+#endif
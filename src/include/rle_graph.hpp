@@ -0,0 +1,138 @@
+#ifndef RLE_GRAPH_HPP
+#define RLE_GRAPH_HPP
+
+#include "connectivity.hpp"
+#include "graph.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace gr {
+
+// The obstacles of a map as runs of consecutive obstacle cells per row, so
+// that memory grows with the number of runs rather than of cells. Every row
+// ends with a run reaching past any column, which makes cells past the end
+// of a short row obstacles like cells off the map.
+class RunRows {
+public:
+    // Cells [begin, end) of a row
+    struct Run {
+        std::uint32_t begin {};
+        std::uint32_t end {};
+    };
+    struct Cell {
+        std::uint64_t row {};
+        std::uint64_t col {};
+    };
+
+    // Reads one line at a time, with the same checks as loadMap
+    static RunRows fromFile(std::string_view fname);
+    static RunRows fromMap(MapData const& map);
+
+    [[nodiscard]] std::size_t rowCount() const { return rowRun.size() - 1; }
+    // Length of the longest row
+    [[nodiscard]] std::size_t width() const { return cols; }
+    [[nodiscard]] std::size_t runCount() const { return runs.size(); }
+    [[nodiscard]] std::size_t memoryBytes() const
+    {
+        return runs.capacity() * sizeof(Run) + rowRun.capacity() * sizeof(std::size_t) + ends.capacity() * sizeof(Cell);
+    }
+    [[nodiscard]] std::optional<Cell> startCell() const { return start; }
+    [[nodiscard]] std::span<Cell const> endCells() const { return ends; }
+
+    // Out of range cells are not free
+    [[nodiscard]] bool isFree(std::int64_t row, std::int64_t col) const;
+    // The 3x3 block around a cell in one binary search per row: bit
+    // (dx + 1) * 3 + dy + 1 is set when (row + dx, col + dy) is free
+    [[nodiscard]] std::uint16_t around(std::int64_t row, std::int64_t col) const;
+
+private:
+    inline static constexpr std::uint32_t rowEnd { std::numeric_limits<std::uint32_t>::max() };
+
+    // Throws InvalidGraphException on unknown cells or a repeated start
+    void addRow(std::string_view line);
+    // Gives back what the vectors grew by past their size
+    void shrink();
+    [[nodiscard]] std::span<Run const> row(std::size_t r) const
+    {
+        return { runs.data() + rowRun[r], rowRun[r + 1] - rowRun[r] };
+    }
+
+    std::vector<Run> runs {};
+    // Row r spans [rowRun[r], rowRun[r + 1]) of runs
+    std::vector<std::size_t> rowRun { 0 };
+    std::size_t cols {};
+    std::optional<Cell> start {};
+    std::vector<Cell> ends {};
+};
+
+// Grid over RunRows, each neighbour a binary search away. Vertex ids are
+// row * width + col, like TiledGraph, and solvers keep sparse state on it,
+// so a query only costs memory for what it explores
+template <Connectivity C, typename D = Distance>
+class RleGraph {
+public:
+    using VertexId = std::uint64_t;
+    using DistanceType = D;
+    inline static constexpr bool sparseState { true };
+
+    RleGraph() = default;
+    explicit RleGraph(RunRows rows_)
+        : rows { std::move(rows_) }
+    {
+        for (auto const& cell : rows.endCells())
+            ends.push_back(idOf(cell));
+    }
+
+    void fromFile(std::string_view fname) { *this = RleGraph { RunRows::fromFile(fname) }; }
+    void fromMap(MapData const& map) { *this = RleGraph { RunRows::fromMap(map) }; }
+
+    [[nodiscard]] std::size_t vertexCount() const { return rows.rowCount() * rows.width(); }
+    [[nodiscard]] std::optional<VertexId> startId() const
+    {
+        auto const cell = rows.startCell();
+        return cell ? std::optional<VertexId> { idOf(*cell) } : std::nullopt;
+    }
+    [[nodiscard]] std::optional<VertexId> endId() const
+    {
+        return ends.empty() ? std::nullopt : std::optional<VertexId> { ends.front() };
+    }
+    [[nodiscard]] std::span<VertexId const> endIds() const { return ends; }
+    [[nodiscard]] RunRows const& runs() const { return rows; }
+
+    [[nodiscard]] bool isFree(VertexId id) const
+    {
+        return rows.isFree(static_cast<std::int64_t>(id / rows.width()), static_cast<std::int64_t>(id % rows.width()));
+    }
+
+    template <typename F>
+    void forEachNeighbour(VertexId id, F&& f) const
+    {
+        auto const cols = static_cast<std::int64_t>(rows.width());
+        auto const row = static_cast<std::int64_t>(id) / cols;
+        auto const col = static_cast<std::int64_t>(id) % cols;
+        auto const near = rows.around(row, col);
+        auto const free = [&](int dx, int dy) { return (near >> ((dx + 1) * 3 + dy + 1) & 1u) != 0; };
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            ((C::legal(free, C::moves[I].dx, C::moves[I].dy)
+                    ? (void)f(static_cast<VertexId>((row + C::moves[I].dx) * cols + col + C::moves[I].dy), moveCosts<C, D>[I])
+                    : void()),
+                ...);
+        }(std::make_index_sequence<C::moves.size()> {});
+    }
+
+private:
+    [[nodiscard]] VertexId idOf(RunRows::Cell const& cell) const { return cell.row * rows.width() + cell.col; }
+
+    RunRows rows {};
+    std::vector<VertexId> ends {};
+};
+
+}
+
+#endif
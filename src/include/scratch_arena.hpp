@@ -0,0 +1,50 @@
+#ifndef SCRATCH_ARENA_HPP
+#define SCRATCH_ARENA_HPP
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+
+// Monotonic memory for the per query containers of a solver. Everything is
+// dropped at once by rewind(). The buffer is sized by the largest query
+// seen so far, so once it has grown a query makes no call to the global
+// allocator.
+class ScratchArena {
+public:
+    ScratchArena();
+    ScratchArena(ScratchArena const&) = delete;
+    ScratchArena& operator=(ScratchArena const&) = delete;
+
+    [[nodiscard]] std::pmr::memory_resource* resource() { return &tracking; }
+
+    // Everything allocated from resource() must be gone before calling this
+    void rewind();
+
+    [[nodiscard]] std::size_t capacity() const { return bytes; }
+
+private:
+    // Counts what the arena hands out, to size the buffer of the next query
+    class Tracking : public std::pmr::memory_resource {
+    public:
+        explicit Tracking(ScratchArena& owner_)
+            : owner { owner_ }
+        {
+        }
+        std::size_t used {};
+
+    private:
+        void* do_allocate(std::size_t size, std::size_t alignment) override;
+        void do_deallocate(void* p, std::size_t size, std::size_t alignment) override;
+        bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override;
+
+        ScratchArena& owner;
+    };
+
+    std::unique_ptr<std::byte[]> buffer {};
+    std::size_t bytes {};
+    std::optional<std::pmr::monotonic_buffer_resource> arena {};
+    Tracking tracking { *this };
+};
+
+#endif
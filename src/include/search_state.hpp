@@ -0,0 +1,103 @@
+#ifndef SEARCH_STATE_HPP
+#define SEARCH_STATE_HPP
+
+#include "graph.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+// Tentative distance, predecessor and settled flag of every vertex reached
+// by a search. Unreached vertices read as infinitely far. Setting a vertex
+// again unsettles it. Per query memory comes from
+// the resource given to reset() and is handed back by release().
+
+// One slot per vertex, for graphs that fit in memory. Slots carry the
+// generation of the query that wrote them: reset() starts a new generation
+// instead of clearing, so a query costs nothing for the vertices it skips
+template <typename D, typename Id>
+class DenseState {
+public:
+    void release() { }
+    void reset(std::size_t vertices, Id source, std::pmr::memory_resource*)
+    {
+        defaultPred = source;
+        if (slots.size() != vertices || ++generation == 0) {
+            slots.assign(vertices, {});
+            generation = 1;
+        }
+    }
+    [[nodiscard]] D dist(Id v) const
+    {
+        auto const& slot = slots[static_cast<std::size_t>(v)];
+        return slot.generation == generation ? slot.dist : gr::infiniteDistance<D>;
+    }
+    [[nodiscard]] Id pred(Id v) const
+    {
+        auto const& slot = slots[static_cast<std::size_t>(v)];
+        return slot.generation == generation ? slot.pred : defaultPred;
+    }
+    [[nodiscard]] bool settled(Id v) const
+    {
+        auto const& slot = slots[static_cast<std::size_t>(v)];
+        return slot.generation == generation && slot.settled;
+    }
+    void set(Id v, D d, Id p) { slots[static_cast<std::size_t>(v)] = { generation, d, p, false }; }
+    // Only for a vertex set in this generation
+    void settle(Id v) { slots[static_cast<std::size_t>(v)].settled = true; }
+
+private:
+    // Kept together, a relaxation touches a single cache line. The flag
+    // fits in the padding after pred
+    struct Slot {
+        std::uint32_t generation {};
+        D dist {};
+        Id pred {};
+        bool settled {};
+    };
+    std::vector<Slot> slots {};
+    std::uint32_t generation {};
+    Id defaultPred {};
+};
+
+// Grows with the reached vertices only, for graphs too large for a slot each
+template <typename D, typename Id>
+class SparseState {
+public:
+    void release() { entries.reset(); }
+    void reset(std::size_t, Id source, std::pmr::memory_resource* resource)
+    {
+        entries.emplace(resource);
+        defaultPred = source;
+    }
+    [[nodiscard]] D dist(Id v) const
+    {
+        auto it = entries->find(v);
+        return it == entries->end() ? gr::infiniteDistance<D> : it->second.dist;
+    }
+    [[nodiscard]] Id pred(Id v) const
+    {
+        auto it = entries->find(v);
+        return it == entries->end() ? defaultPred : it->second.pred;
+    }
+    [[nodiscard]] bool settled(Id v) const
+    {
+        auto it = entries->find(v);
+        return it != entries->end() && it->second.settled;
+    }
+    void set(Id v, D d, Id p) { entries->insert_or_assign(v, Entry { d, p, false }); }
+    void settle(Id v) { entries->find(v)->second.settled = true; }
+
+private:
+    struct Entry {
+        D dist {};
+        Id pred {};
+        bool settled {};
+    };
+    std::optional<std::pmr::unordered_map<Id, Entry>> entries {};
+    Id defaultPred {};
+};
+
+#endif
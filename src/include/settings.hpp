@@ -1,6 +1,9 @@
 #ifndef SETTINGS_HPP
 #define SETTINGS_HPP
 
+#include "connectivity.hpp"
+#include "graph.hpp"
+#include "map_loader.hpp"
 #include <cstddef>
 #include <string>
 #include <variant>
@@ -20,6 +23,13 @@ struct Grid {
     unsigned int cols {};
 };
 
+// A map read by the App once the window is up
+struct MapFile {
+    std::string path {};
+    // What the window is first sized for, see peekMapShape
+    gr::MapShape shape {};
+};
+
 struct WindowSize {
     int width {};
     int height {};
@@ -28,8 +38,10 @@ struct WindowSize {
 struct Settings {
     CellSize cellSize {};
     WindowSize windowSize {};
-    std::variant<Grid, std::string> grid {};
+    // Either the size of an empty grid or the map at graphPath
+    std::variant<Grid, MapFile> grid {};
     int timeStep {};
+    gr::ConnectivityMode connectivity { gr::ConnectivityMode::EIGHT };
 };
 
 Settings getSettings(int argc, char** argv);
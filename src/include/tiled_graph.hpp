@@ -0,0 +1,169 @@
+#ifndef TILED_GRAPH_HPP
+#define TILED_GRAPH_HPP
+
+#include "connectivity.hpp"
+#include "graph.hpp"
+#include "io.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <list>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace gr {
+
+class InvalidTiledMapException : std::exception {
+public:
+    const char* what() const noexcept override
+    {
+        return "Invalid tiled map file";
+    }
+};
+
+// On disk a tiled map is a TiledHeader followed by its tiles in row major
+// order. A tile holds tileSize * tileSize bytes, row major, 1 for a free
+// cell and 0 for an obstacle. Cells past the edge of the map are obstacles.
+struct TiledHeader {
+    inline static constexpr std::uint64_t noCell { std::numeric_limits<std::uint64_t>::max() };
+    char magic[8] { 'D', 'J', 'K', 'T', 'I', 'L', 'E', '1' };
+    std::uint64_t rows {};
+    std::uint64_t cols {};
+    std::uint64_t tileSize {};
+    // Cell indices (row * cols + col) of 'A' and 'B'
+    std::uint64_t start { noCell };
+    std::uint64_t end { noCell };
+};
+
+// Converts an ASCII map to a tiled map, keeping only tileSize rows in memory
+void writeTiled(std::string_view asciiMap, std::string_view tiledMap, std::size_t tileSize = 256);
+
+// Writes a tiled map one ASCII row at a time, keeping only tileSize rows in
+// memory. The header, endpoints included, is written first
+class TiledWriter {
+public:
+    TiledWriter(std::string_view fname, TiledHeader const& head);
+
+    // Cells past the end of a short row are obstacles
+    void addRow(std::string_view line);
+    // Writes the last, partial band of tiles
+    void finish();
+
+private:
+    void flush();
+
+    io::File out;
+    std::uint64_t tileSize {};
+    std::uint64_t rows {};
+    std::vector<char> band {};
+};
+
+// Keeps at most maxResident tiles of a tiled map in memory, dropping the
+// least recently used one when a new tile is needed
+class TileStore {
+public:
+    TileStore(std::string_view fname, std::size_t maxResident);
+
+    [[nodiscard]] TiledHeader const& header() const { return head; }
+    [[nodiscard]] std::size_t residentTiles() const { return resident.size(); }
+    [[nodiscard]] std::size_t tileLoads() const { return loads; }
+
+    // Out of range cells are not free
+    [[nodiscard]] bool isFree(std::int64_t row, std::int64_t col) const
+    {
+        if (row < 0 || col < 0
+            || static_cast<std::uint64_t>(row) >= head.rows
+            || static_cast<std::uint64_t>(col) >= head.cols)
+            return false;
+        auto const r = static_cast<std::uint64_t>(row);
+        auto const c = static_cast<std::uint64_t>(col);
+        auto const key = (r / head.tileSize) * tilesPerRow + c / head.tileSize;
+        if (key != lastKey) {
+            lastTile = tile(key);
+            lastKey = key;
+        }
+        return lastTile[(r % head.tileSize) * head.tileSize + c % head.tileSize] != 0;
+    }
+
+private:
+    struct Resident {
+        std::vector<unsigned char> cells {};
+        std::list<std::uint64_t>::iterator use {};
+    };
+
+    unsigned char const* tile(std::uint64_t key) const;
+    unsigned char const* load(std::uint64_t key, Resident& entry) const;
+
+    TiledHeader head {};
+    std::uint64_t tilesPerRow {};
+    std::size_t maxResident {};
+    mutable io::File file;
+    // Most recently used first
+    mutable std::list<std::uint64_t> uses {};
+    mutable std::unordered_map<std::uint64_t, Resident> resident {};
+    mutable std::size_t loads {};
+    mutable std::uint64_t lastKey { TiledHeader::noCell };
+    mutable unsigned char const* lastTile { nullptr };
+};
+
+// Grid backed by a TileStore. Vertex ids are row * cols + col. Solvers keep
+// sparse state on it, so a query only costs memory for what it explores
+template <Connectivity C, typename D = Distance>
+class TiledGraph {
+public:
+    using VertexId = std::uint64_t;
+    using DistanceType = D;
+    inline static constexpr bool sparseState { true };
+
+    explicit TiledGraph(std::string_view fname, std::size_t maxResidentTiles = 64)
+        : store { fname, maxResidentTiles }
+    {
+    }
+
+    [[nodiscard]] std::size_t vertexCount() const
+    {
+        return static_cast<std::size_t>(store.header().rows * store.header().cols);
+    }
+    [[nodiscard]] std::optional<VertexId> startId() const { return endpoint(store.header().start); }
+    [[nodiscard]] std::optional<VertexId> endId() const { return endpoint(store.header().end); }
+    [[nodiscard]] TileStore const& tiles() const { return store; }
+
+    [[nodiscard]] bool isFree(VertexId id) const
+    {
+        auto const cols = store.header().cols;
+        return store.isFree(static_cast<std::int64_t>(id / cols), static_cast<std::int64_t>(id % cols));
+    }
+
+    template <typename F>
+    void forEachNeighbour(VertexId id, F&& f) const
+    {
+        auto const cols = static_cast<std::int64_t>(store.header().cols);
+        auto const row = static_cast<std::int64_t>(id) / cols;
+        auto const col = static_cast<std::int64_t>(id) % cols;
+        auto const free = [&](int dx, int dy) { return store.isFree(row + dx, col + dy); };
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            ((C::legal(free, C::moves[I].dx, C::moves[I].dy)
+                    ? (void)f(static_cast<VertexId>((row + C::moves[I].dx) * cols + col + C::moves[I].dy), moveCosts<C, D>[I])
+                    : void()),
+                ...);
+        }(std::make_index_sequence<C::moves.size()> {});
+    }
+
+private:
+    [[nodiscard]] static std::optional<VertexId> endpoint(std::uint64_t cell)
+    {
+        if (cell == TiledHeader::noCell)
+            return std::nullopt;
+        return cell;
+    }
+
+    TileStore store;
+};
+
+}
+
+#endif
@@ -1,6 +1,15 @@
 #include "io.hpp"
 #include <ios>
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define IO_HAS_MMAP 1
+#else
+#define IO_HAS_MMAP 0
+#endif
 #include <iterator>
+#include <string>
 #include <string_view>
 
 namespace io {
@@ -34,6 +43,20 @@ std::string File::readline()
     return str;
 }
 
+void File::read(char* dst, std::size_t count)
+{
+    stream.read(dst, static_cast<std::streamsize>(count));
+    if (!stateok())
+        throw FileException { state() };
+}
+
+void File::seek(std::streamoff pos)
+{
+    stream.seekg(pos);
+    if (!stateok())
+        throw FileException { state() };
+}
+
 std::ios_base::iostate File::state() const { return stream.rdstate(); }
 
 bool File::stateok() const { return state() == std::ios_base::goodbit; }
@@ -73,4 +96,46 @@ File::iterator File::iterator::operator++(int)
 
 void File::iterator::setnull() { s = nullptr; }
 
-}
\ No newline at end of file
+#if IO_HAS_MMAP
+bool const mappedFilesAvailable { true };
+
+MappedFile::MappedFile(std::string_view fname, std::size_t size)
+    : mSize { size }
+{
+    std::string const name { fname };
+    int const fd = ::open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        throw FileException { std::ios_base::failbit };
+    if (size != 0) {
+        if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            ::close(fd);
+            throw FileException { std::ios_base::failbit };
+        }
+        void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) {
+            ::close(fd);
+            throw FileException { std::ios_base::failbit };
+        }
+        mData = static_cast<char*>(p);
+    }
+    // The mapping stays valid without the descriptor
+    ::close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+    if (mData != nullptr)
+        ::munmap(mData, mSize);
+}
+#else
+bool const mappedFilesAvailable { false };
+
+MappedFile::MappedFile(std::string_view, std::size_t)
+{
+    throw FileException { std::ios_base::failbit };
+}
+
+MappedFile::~MappedFile() = default;
+#endif
+
+}
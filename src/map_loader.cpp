@@ -0,0 +1,93 @@
+#include "map_loader.hpp"
+#include "io.hpp"
+#include "map_parser.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <utility>
+
+namespace gr {
+
+namespace {
+    // Throws InvalidGraphException if both have a start
+    void append(MapData& map, MapData const& band)
+    {
+        auto const base = map.cells.size();
+        if (band.start) {
+            if (map.start)
+                throw InvalidGraphException {};
+            map.start = base + *band.start;
+        }
+        for (auto e : band.ends)
+            map.ends.push_back(base + e);
+        map.cells.insert(map.cells.end(), band.cells.begin(), band.cells.end());
+        for (std::size_t r = 1; r < band.rowStart.size(); ++r)
+            map.rowStart.push_back(base + band.rowStart[r]);
+        map.width = std::max(map.width, band.width);
+    }
+}
+
+MapShape peekMapShape(std::string_view fname)
+{
+    io::File file { fname, io::in | io::bin };
+    auto const size = static_cast<std::size_t>(std::filesystem::file_size(fname));
+    auto const cols = file.readline().size();
+    // A last line may lack its newline
+    return { .rows = (size + cols) / (cols + 1), .cols = cols };
+}
+
+MapLoader::MapLoader(std::string fname, std::function<void(MapData const&)> then)
+    : worker { [this, fname = std::move(fname), then = std::move(then)](std::stop_token stop) { load(stop, fname, then); } }
+{
+}
+
+bool MapLoader::poll(MapData& rows)
+{
+    std::scoped_lock lock { mutex };
+    if (error)
+        std::rethrow_exception(error);
+    append(rows, pending);
+    pending = {};
+    return finished;
+}
+
+void MapLoader::load(std::stop_token stop, std::string const& fname, std::function<void(MapData const&)> const& then)
+{
+    // Enough to keep a band from costing more in locking than in parsing
+    constexpr std::size_t bandSize { std::size_t { 1 } << 20 };
+    try {
+        io::File file { fname, io::in | io::bin };
+        auto left = static_cast<std::size_t>(std::filesystem::file_size(fname));
+        MapData map {};
+        // Bands end right after a newline, the start of the next line is
+        // carried over to the next one
+        std::string text {};
+        while (left != 0) {
+            if (stop.stop_requested())
+                return;
+            auto const carried = text.size();
+            auto const count = std::min(left, bandSize);
+            text.resize(carried + count);
+            file.read(text.data() + carried, count);
+            left -= count;
+            // npos + 1 is 0: no whole line yet
+            auto const end = left == 0 ? text.size() : text.rfind('\n') + 1;
+            if (end == 0)
+                continue;
+            auto const band = parseMap({ text.data(), end });
+            text.erase(0, end);
+            append(map, band);
+            std::scoped_lock lock { mutex };
+            append(pending, band);
+        }
+        then(map);
+    } catch (...) {
+        std::scoped_lock lock { mutex };
+        error = std::current_exception();
+    }
+    std::scoped_lock lock { mutex };
+    finished = true;
+}
+
+}
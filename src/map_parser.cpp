@@ -0,0 +1,212 @@
+#include "map_parser.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <optional>
+#include <thread>
+#include <vector>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace gr {
+
+namespace {
+    // Each bit of a mask stands for one byte of a block
+    struct BlockMasks {
+        std::uint32_t newline {};
+        std::uint32_t endpoint {};
+        std::uint32_t invalid {};
+    };
+
+#if defined(__AVX2__)
+    inline constexpr std::size_t blockSize { 32 };
+
+    BlockMasks classify(char const* p)
+    {
+        auto const v = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p));
+        auto const eq = [&](char c) { return _mm256_cmpeq_epi8(v, _mm256_set1_epi8(c)); };
+        auto const newline = eq('\n');
+        auto const endpoint = _mm256_or_si256(eq(static_cast<char>(pointStart)), eq(static_cast<char>(pointEnd)));
+        auto const valid = _mm256_or_si256(_mm256_or_si256(newline, endpoint),
+            _mm256_or_si256(eq(static_cast<char>(pointEmpty)), eq(static_cast<char>(pointObstacle))));
+        return {
+            static_cast<std::uint32_t>(_mm256_movemask_epi8(newline)),
+            static_cast<std::uint32_t>(_mm256_movemask_epi8(endpoint)),
+            ~static_cast<std::uint32_t>(_mm256_movemask_epi8(valid))
+        };
+    }
+#elif defined(__SSE2__)
+    inline constexpr std::size_t blockSize { 16 };
+
+    BlockMasks classify(char const* p)
+    {
+        auto const v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p));
+        auto const eq = [&](char c) { return _mm_cmpeq_epi8(v, _mm_set1_epi8(c)); };
+        auto const newline = eq('\n');
+        auto const endpoint = _mm_or_si128(eq(static_cast<char>(pointStart)), eq(static_cast<char>(pointEnd)));
+        auto const valid = _mm_or_si128(_mm_or_si128(newline, endpoint),
+            _mm_or_si128(eq(static_cast<char>(pointEmpty)), eq(static_cast<char>(pointObstacle))));
+        return {
+            static_cast<std::uint32_t>(_mm_movemask_epi8(newline)),
+            static_cast<std::uint32_t>(_mm_movemask_epi8(endpoint)),
+            static_cast<std::uint32_t>(~_mm_movemask_epi8(valid)) & 0xffffu
+        };
+    }
+#else
+    inline constexpr std::size_t blockSize { 8 };
+
+    BlockMasks classify(char const* p)
+    {
+        BlockMasks m {};
+        for (std::size_t i = 0; i < blockSize; ++i) {
+            auto const c = static_cast<CharType>(p[i]);
+            auto const bit = std::uint32_t { 1 } << i;
+            if (p[i] == '\n')
+                m.newline |= bit;
+            else if (c == pointStart || c == pointEnd)
+                m.endpoint |= bit;
+            else if (c != pointEmpty && c != pointObstacle)
+                m.invalid |= bit;
+        }
+        return m;
+    }
+#endif
+
+    BlockMasks classifyTail(char const* p, std::size_t count)
+    {
+        char block[blockSize];
+        // Padded with valid cells, masked out again below
+        std::memset(block, static_cast<char>(pointEmpty), blockSize);
+        std::memcpy(block, p, count);
+        auto m = classify(block);
+        auto const keep = (std::uint32_t { 1 } << count) - 1;
+        m.newline &= keep;
+        m.endpoint &= keep;
+        return m;
+    }
+
+    // What the first pass learns about a range of whole lines
+    struct Chunk {
+        std::size_t begin {};
+        std::size_t end {};
+        std::vector<std::size_t> rowLengths {};
+        // Cell indices within the chunk
+        std::vector<std::size_t> starts {};
+        std::vector<std::size_t> ends {};
+        bool invalid {};
+        std::size_t cellBase {};
+        std::size_t rowBase {};
+    };
+
+    void scan(std::string_view text, Chunk& chunk)
+    {
+        std::size_t lineBegin { chunk.begin };
+        std::size_t newlines {};
+        for (std::size_t pos = chunk.begin; pos < chunk.end; pos += blockSize) {
+            auto const count = std::min(blockSize, chunk.end - pos);
+            auto const m = count == blockSize ? classify(text.data() + pos) : classifyTail(text.data() + pos, count);
+            if (m.invalid != 0) {
+                chunk.invalid = true;
+                return;
+            }
+            for (auto bits = m.endpoint; bits != 0; bits &= bits - 1) {
+                auto const i = static_cast<std::size_t>(std::countr_zero(bits));
+                auto const before = static_cast<std::size_t>(std::popcount(m.newline & ((std::uint32_t { 1 } << i) - 1)));
+                auto const cell = pos + i - chunk.begin - newlines - before;
+                (static_cast<CharType>(text[pos + i]) == pointStart ? chunk.starts : chunk.ends).push_back(cell);
+            }
+            for (auto bits = m.newline; bits != 0; bits &= bits - 1) {
+                auto const at = pos + static_cast<std::size_t>(std::countr_zero(bits));
+                chunk.rowLengths.push_back(at - lineBegin);
+                lineBegin = at + 1;
+            }
+            newlines += static_cast<std::size_t>(std::popcount(m.newline));
+        }
+        // Like getline, a last line without a newline is still a row
+        if (lineBegin < chunk.end)
+            chunk.rowLengths.push_back(chunk.end - lineBegin);
+    }
+
+    void copyRows(std::string_view text, Chunk const& chunk, MapData& map)
+    {
+        auto src = text.data() + chunk.begin;
+        auto dst = map.cells.data() + chunk.cellBase;
+        auto cell = chunk.cellBase;
+        for (std::size_t r = 0; r < chunk.rowLengths.size(); ++r) {
+            auto const length = chunk.rowLengths[r];
+            std::memcpy(dst, src, length);
+            dst += length;
+            src += length + 1;
+            cell += length;
+            map.rowStart[chunk.rowBase + r + 1] = cell;
+        }
+    }
+
+    template <typename F>
+    void forEachChunk(std::vector<Chunk>& chunks, F&& f)
+    {
+        std::vector<std::jthread> workers {};
+        workers.reserve(chunks.size() - 1);
+        for (std::size_t i = 1; i < chunks.size(); ++i)
+            workers.emplace_back([&, i] { f(chunks[i]); });
+        f(chunks[0]);
+    }
+}
+
+MapData parseMap(std::string_view text, unsigned threads)
+{
+    // Below this many bytes per thread, starting threads costs more than it saves
+    constexpr std::size_t minChunk { std::size_t { 1 } << 20 };
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    auto const count = std::clamp<std::size_t>(text.size() / minChunk, 1, threads);
+
+    // Chunks end right after a newline, so that every row lies in one of them
+    std::vector<Chunk> chunks(count);
+    std::size_t begin {};
+    for (std::size_t i = 0; i < count; ++i) {
+        auto end = i + 1 == count ? text.size() : std::max(begin, text.size() * (i + 1) / count);
+        if (end < text.size()) {
+            auto const newline = text.find('\n', end);
+            end = newline == std::string_view::npos ? text.size() : newline + 1;
+        }
+        chunks[i].begin = begin;
+        chunks[i].end = end;
+        begin = end;
+    }
+
+    forEachChunk(chunks, [&](Chunk& chunk) { scan(text, chunk); });
+
+    MapData map {};
+    std::size_t cells {};
+    std::size_t rows {};
+    for (auto& chunk : chunks) {
+        if (chunk.invalid)
+            throw InvalidGraphException {};
+        for (auto s : chunk.starts) {
+            if (map.start)
+                throw InvalidGraphException {};
+            map.start = cells + s;
+        }
+        for (auto e : chunk.ends)
+            map.ends.push_back(cells + e);
+        chunk.cellBase = cells;
+        chunk.rowBase = rows;
+        cells += std::reduce(chunk.rowLengths.begin(), chunk.rowLengths.end(), std::size_t {});
+        rows += chunk.rowLengths.size();
+        for (auto length : chunk.rowLengths)
+            map.width = std::max(map.width, length);
+    }
+
+    map.cells.resize(cells);
+    map.rowStart.assign(rows + 1, 0);
+    forEachChunk(chunks, [&](Chunk const& chunk) { copyRows(text, chunk, map); });
+    return map;
+}
+
+}
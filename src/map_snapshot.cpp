@@ -0,0 +1,151 @@
+#include "map_snapshot.hpp"
+#include <algorithm>
+
+namespace gr {
+
+template <Connectivity C, typename D>
+MapSnapshot<C, D>::MapSnapshot(MapData const& map)
+    : rowCount { map.rowCount() }
+    , colCount { map.width }
+{
+    for (std::size_t first = 0; first < rowCount; first += chunkRows) {
+        auto const last = std::min(first + chunkRows, rowCount);
+        auto chunk = std::make_shared<Chunk>();
+        chunk->types.assign((last - first) * colCount, pointObstacle);
+        for (auto r = first; r < last; ++r)
+            std::copy(map.cells.begin() + static_cast<std::ptrdiff_t>(map.rowStart[r]),
+                map.cells.begin() + static_cast<std::ptrdiff_t>(map.rowStart[r + 1]),
+                chunk->types.begin() + static_cast<std::ptrdiff_t>((r - first) * colCount));
+        chunks.push_back(std::move(chunk));
+    }
+
+    auto const idOf = [&](std::size_t cell) {
+        auto const r = static_cast<std::size_t>(std::upper_bound(map.rowStart.begin(), map.rowStart.end(), cell) - map.rowStart.begin()) - 1;
+        return static_cast<VertexId>(r * colCount + cell - map.rowStart[r]);
+    };
+    if (map.start)
+        start = idOf(*map.start);
+    for (auto e : map.ends)
+        ends.push_back(idOf(e));
+
+    // Masks and clearances need every type in place
+    auto const clearances = computeClearance(rowCount, colCount, [&](std::size_t r, std::size_t col) {
+        return isFree(static_cast<std::int64_t>(r), static_cast<std::int64_t>(col));
+    });
+    for (std::size_t c = 0; c < chunks.size(); ++c) {
+        auto& chunk = *chunks[c];
+        chunk.masks.resize(chunk.types.size());
+        for (std::size_t i = 0; i < chunk.types.size(); ++i)
+            chunk.masks[i] = movesAt(static_cast<std::int64_t>(c * chunkRows + i / colCount), static_cast<std::int64_t>(i % colCount));
+        auto const first = clearances.begin() + static_cast<std::ptrdiff_t>(c * chunkRows * colCount);
+        chunk.clearances.assign(first, first + static_cast<std::ptrdiff_t>(chunk.types.size()));
+    }
+}
+
+template <Connectivity C, typename D>
+bool MapSnapshot<C, D>::isFree(std::int64_t row, std::int64_t col) const
+{
+    if (row < 0 || col < 0
+        || static_cast<std::size_t>(row) >= rowCount
+        || static_cast<std::size_t>(col) >= colCount)
+        return false;
+    return type(static_cast<VertexId>(row) * colCount + static_cast<VertexId>(col)) != pointObstacle;
+}
+
+template <Connectivity C, typename D>
+NeighbourMask MapSnapshot<C, D>::movesAt(std::int64_t row, std::int64_t col) const
+{
+    return movesFrom<C>([&](int dx, int dy) { return isFree(row + dx, col + dy); });
+}
+
+template <Connectivity C, typename D>
+Clearance MapSnapshot<C, D>::clearanceAt(std::int64_t row, std::int64_t col) const
+{
+    if (row < 0 || col < 0
+        || static_cast<std::size_t>(row) >= rowCount
+        || static_cast<std::size_t>(col) >= colCount)
+        return 0;
+    return clearance(static_cast<VertexId>(row) * colCount + static_cast<VertexId>(col));
+}
+
+template <Connectivity C, typename D>
+std::shared_ptr<MapSnapshot<C, D> const> MapSnapshot<C, D>::edited(std::span<CellEdit const> edits) const
+{
+    std::shared_ptr<MapSnapshot> next { new MapSnapshot { *this } };
+    next->number = number + 1;
+    // Chunks are copied the first time this edit writes to them
+    std::vector<bool> copied(chunks.size(), false);
+    auto writable = [&](std::size_t chunk) -> Chunk& {
+        if (!copied[chunk]) {
+            next->chunks[chunk] = std::make_shared<Chunk>(*chunks[chunk]);
+            copied[chunk] = true;
+        }
+        return *next->chunks[chunk];
+    };
+    auto setType = [&](VertexId id, CharType t) {
+        auto const [chunk, offset] = next->locate(id);
+        writable(chunk).types[offset] = t;
+    };
+
+    for (auto const& e : edits) {
+        if (e.row >= rowCount || e.col >= colCount)
+            throw InvalidGraphException {};
+        switch (e.type) {
+        case pointEmpty:
+        case pointObstacle:
+        case pointStart:
+        case pointEnd:
+            break;
+        default:
+            throw InvalidGraphException {};
+        }
+
+        auto const id = static_cast<VertexId>(e.row * colCount + e.col);
+        bool const wasObstacle = next->type(id) == pointObstacle;
+        if (next->start == id)
+            next->start = std::nullopt;
+        std::erase(next->ends, id);
+        if (e.type == pointStart) {
+            if (next->start)
+                setType(*next->start, pointEmpty);
+            next->start = id;
+        } else if (e.type == pointEnd) {
+            next->ends.push_back(id);
+        }
+        setType(id, e.type);
+
+        if (wasObstacle == (e.type == pointObstacle))
+            continue;
+        // Only the 3x3 block around a toggled cell can see its legality change
+        auto const row = static_cast<std::int64_t>(e.row);
+        auto const col = static_cast<std::int64_t>(e.col);
+        for (auto r = std::max<std::int64_t>(row - 1, 0); r <= std::min<std::int64_t>(row + 1, static_cast<std::int64_t>(rowCount) - 1); ++r) {
+            for (auto c = std::max<std::int64_t>(col - 1, 0); c <= std::min<std::int64_t>(col + 1, static_cast<std::int64_t>(colCount) - 1); ++c) {
+                auto const [chunk, offset] = next->locate(static_cast<VertexId>(r) * colCount + static_cast<VertexId>(c));
+                writable(chunk).masks[offset] = next->movesAt(r, c);
+            }
+        }
+
+        auto const at = [&](std::int64_t r, std::int64_t c) { return next->clearanceAt(r, c); };
+        auto const reach = clearanceReach(row, col, at);
+        refillClearance(std::max<std::int64_t>(row - reach, 0), std::min<std::int64_t>(row + reach + 1, static_cast<std::int64_t>(rowCount)),
+            std::max<std::int64_t>(col - reach, 0), std::min<std::int64_t>(col + reach + 1, static_cast<std::int64_t>(colCount)),
+            [&](std::int64_t r, std::int64_t c) { return next->isFree(r, c); },
+            at,
+            [&](std::int64_t r, std::int64_t c, Clearance value) {
+                auto const [chunk, offset] = next->locate(static_cast<VertexId>(r) * colCount + static_cast<VertexId>(c));
+                // Most of the square keeps its clearance, copy no chunk for it
+                if (next->chunks[chunk]->clearances[offset] != value)
+                    writable(chunk).clearances[offset] = value;
+            });
+    }
+    return next;
+}
+
+template class MapSnapshot<FourConnected>;
+template class MapSnapshot<EightConnected>;
+template class MapSnapshot<CornerCutting>;
+template class MapSnapshot<FourConnected, IntDistance>;
+template class MapSnapshot<EightConnected, IntDistance>;
+template class MapSnapshot<CornerCutting, IntDistance>;
+}
@@ -18,22 +18,22 @@ MousePos getMousePos(sf::Event const& event)
 }
 
 }
-void MouseEventHandler::handleEvent(sf::Event const& event, gr::Vertex& ver)
+void MouseEventHandler::handleEvent(sf::Event const& event, gr::Vertex& ver, gr::Graph& graph)
 {
     switch (event.type) {
     case sf::Event::MouseButtonPressed:
     case sf::Event::MouseButtonReleased:
-        MouseEventHandler::handleButtonEvent(event, ver);
+        MouseEventHandler::handleButtonEvent(event, ver, graph);
         break;
     case sf::Event::MouseMoved:
-        MouseEventHandler::handleMoveEvent(event, ver);
+        MouseEventHandler::handleMoveEvent(event, ver, graph);
         break;
     default:
         break;
     }
 }
 
-void MouseEventHandler::handleButtonEvent(sf::Event const& event, gr::Vertex& ver)
+void MouseEventHandler::handleButtonEvent(sf::Event const& event, gr::Vertex& ver, gr::Graph& graph)
 {
     switch (ver.type()) {
     case gr::pointStart:
@@ -48,13 +48,13 @@ void MouseEventHandler::handleButtonEvent(sf::Event const& event, gr::Vertex& ve
     case gr::pointObstacle:
         if (event.mouseButton.button == sf::Mouse::Right
             && event.type == sf::Event::MouseButtonPressed)
-            ver.setType(gr::pointEmpty);
+            graph.markAs(ver, gr::pointEmpty);
         state = MouseEventHandler::State::FREE;
         break;
     case gr::pointEmpty:
         if (event.mouseButton.button == sf::Mouse::Left
             && event.type == sf::Event::MouseButtonPressed)
-            ver.setType(gr::pointObstacle);
+            graph.markAs(ver, gr::pointObstacle);
         state = MouseEventHandler::State::FREE;
         break;
     default:
@@ -62,7 +62,7 @@ void MouseEventHandler::handleButtonEvent(sf::Event const& event, gr::Vertex& ve
     }
 }
 
-void MouseEventHandler::handleMoveEvent(sf::Event const& event, gr::Vertex& ver)
+void MouseEventHandler::handleMoveEvent(sf::Event const& event, gr::Vertex& ver, gr::Graph& graph)
 {
     (void)event;
     switch (ver.type()) {
@@ -76,24 +76,21 @@ void MouseEventHandler::handleMoveEvent(sf::Event const& event, gr::Vertex& ver)
         break;
     case gr::pointObstacle:
         if (state == MouseEventHandler::State::FREE && sf::Mouse::isButtonPressed(sf::Mouse::Right)) {
-            ver.setType(gr::pointEmpty);
+            graph.markAs(ver, gr::pointEmpty);
             state = MouseEventHandler::State::FREE;
         }
         break;
     case gr::pointEmpty:
         if (state == MouseEventHandler::State::FREE && sf::Mouse::isButtonPressed(sf::Mouse::Left))
-            ver.setType(gr::pointObstacle);
+            graph.markAs(ver, gr::pointObstacle);
         else if (state == MouseEventHandler::State::GRABBED_START) {
-            v->setType(gr::pointEmpty);
-            v->setDist(gr::infinite);
+            graph.markAs(*v, gr::pointEmpty);
             v = &ver;
-            v->setType(gr::pointStart);
-            v->setDist(gr::Distance { 0 });
+            graph.markAs(*v, gr::pointStart);
         } else if (state == MouseEventHandler::State::GRABBED_END) {
-            v->setType(gr::pointEmpty);
+            graph.markAs(*v, gr::pointEmpty);
             v = &ver;
-            v->setType(gr::pointEnd);
-            v->setDist(gr::infinite);
+            graph.markAs(*v, gr::pointEnd);
         }
         break;
     default:
@@ -115,6 +112,8 @@ void updateMouseEventHandler(MouseEventHandler& mouseEventHandler, Settings cons
             static_cast<int>(mPos.y / settings.cellSize.height),
             static_cast<int>(mPos.x / settings.cellSize.width)
         };
-        mouseEventHandler.handleEvent(event, *graph.vertexPtr(gr::Position { gr::X { xPos }, gr::Y { yPos } }));
+        // Past the end of a short row there is no cell
+        if (auto ptr = graph.vertexPtr(gr::Position { gr::X { xPos }, gr::Y { yPos } }))
+            mouseEventHandler.handleEvent(event, *ptr, graph);
     }
 }
\ No newline at end of file
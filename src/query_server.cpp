@@ -0,0 +1,425 @@
+#include "query_server.hpp"
+#include "dijkstra.hpp"
+#include "map_snapshot.hpp"
+#include "path_cache.hpp"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <csignal>
+#include <cstddef>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+#if __has_include(<sys/un.h>)
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#define SERVER_HAS_SOCKETS 1
+#else
+#define SERVER_HAS_SOCKETS 0
+#endif
+
+namespace {
+
+std::string_view nextToken(std::string_view& line)
+{
+    auto const begin = line.find_first_not_of(" \t\r");
+    if (begin == std::string_view::npos) {
+        line = {};
+        return {};
+    }
+    line.remove_prefix(begin);
+    auto const end = std::min(line.find_first_of(" \t\r"), line.size());
+    auto const token = line.substr(0, end);
+    line.remove_prefix(end);
+    return token;
+}
+
+template <typename T>
+std::optional<T> toNumber(std::string_view token)
+{
+    T value {};
+    auto const [ptr, ec] = std::from_chars(token.data(), token.data() + token.size(), value);
+    if (ec != std::errc {} || ptr != token.data() + token.size())
+        return std::nullopt;
+    return value;
+}
+
+std::optional<int> toInt(std::string_view token) { return toNumber<int>(token); }
+
+// What a cutoff status is called in answers, nullptr for the others
+char const* cutoff(SearchStatus status)
+{
+    switch (status) {
+    case SearchStatus::COST_LIMIT:
+        return "cost";
+    case SearchStatus::EXPANSION_LIMIT:
+        return "expansions";
+    case SearchStatus::DEADLINE:
+        return "deadline";
+    default:
+        return nullptr;
+    }
+}
+
+void append(std::string& s, double value)
+{
+    char buffer[32];
+    auto const [ptr, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    s.append(buffer, ec == std::errc {} ? ptr : buffer);
+}
+
+std::optional<gr::CharType> toType(std::string_view token)
+{
+    if (token.size() != 1)
+        return std::nullopt;
+    switch (auto const t = static_cast<gr::CharType>(token[0])) {
+    case gr::pointEmpty:
+    case gr::pointObstacle:
+    case gr::pointStart:
+    case gr::pointEnd:
+        return t;
+    }
+    return std::nullopt;
+}
+
+// The cost from a cell to the nearest target were there no obstacles. It
+// makes the search A*, and gives a cutoff a cell to stop at that is closer
+// to the end than the cells around the start
+template <gr::Connectivity C, typename Id>
+class GridHeuristic {
+public:
+    GridHeuristic() = default;
+    explicit GridHeuristic(std::size_t cols_)
+        : cols { cols_ }
+    {
+    }
+
+    void aim(std::span<Id const> targets_) { targets.assign(targets_.begin(), targets_.end()); }
+
+    [[nodiscard]] gr::Distance operator()(Id v) const
+    {
+        auto best = targets.empty() ? gr::Distance { 0 } : gr::infinite;
+        for (auto t : targets) {
+            auto const rows = distance(v / cols, t / cols);
+            auto const columns = distance(v % cols, t % cols);
+            // Diagonal moves cover a step of both at once
+            auto const h = C::moves.size() == 8
+                ? static_cast<double>(std::max(rows, columns) - std::min(rows, columns)) + static_cast<double>(std::min(rows, columns)) * gr::diagonalCost
+                : static_cast<double>(rows + columns);
+            best = std::min(best, gr::Distance { h });
+        }
+        return best;
+    }
+
+private:
+    [[nodiscard]] static std::size_t distance(std::size_t a, std::size_t b) { return a < b ? b - a : a - b; }
+
+    std::size_t cols { 1 };
+    std::vector<Id> targets {};
+};
+
+template <gr::Connectivity C>
+class BasicQueryServer : public QueryServer {
+    using Snapshot = gr::MapSnapshot<C>;
+    using Heuristic = GridHeuristic<C, typename Snapshot::VertexId>;
+
+    class BasicSession : public Session {
+    public:
+        BasicSession(gr::VersionedMap<C>& map_, PathCache<std::string>& cache_)
+            : map { map_ }
+            , cache { cache_ }
+        {
+            // Edits never change the size of the map
+            djk.setHeuristic(Heuristic { map.snapshot()->cols() });
+        }
+
+        std::string answer(std::string_view query) override
+        {
+            auto rest = query;
+            auto const command = nextToken(rest);
+            if (command == "set")
+                return edit(rest);
+            if (command == "stats")
+                return "cache " + std::to_string(cache.hitCount()) + ' ' + std::to_string(cache.missCount());
+            return search(query);
+        }
+
+    private:
+        std::string edit(std::string_view query)
+        {
+            auto const row = toInt(nextToken(query));
+            auto const col = toInt(nextToken(query));
+            auto const type = toType(nextToken(query));
+            if (!row || !col || !type || *row < 0 || *col < 0 || !nextToken(query).empty())
+                return "error expected set row col type";
+            gr::CellEdit const edit { static_cast<std::size_t>(*row), static_cast<std::size_t>(*col), *type };
+            try {
+                return "version " + std::to_string(map.edit({ &edit, 1 })->version());
+            } catch (gr::InvalidGraphException const&) {
+                return "error cell out of the map";
+            }
+        }
+
+        std::string search(std::string_view query)
+        {
+            auto const received = std::chrono::steady_clock::now();
+            int coords[4] {};
+            for (auto& c : coords) {
+                auto const value = toInt(nextToken(query));
+                if (!value)
+                    return "error expected row col row col";
+                c = *value;
+            }
+            bool withPath {};
+            std::size_t agentSize { 1 };
+            SearchLimits<gr::Distance> limits {};
+            for (auto token = nextToken(query); !token.empty(); token = nextToken(query)) {
+                if (token == "path") {
+                    withPath = true;
+                } else if (token == "size") {
+                    auto const value = toNumber<std::size_t>(nextToken(query));
+                    if (!value || *value == 0)
+                        return "error expected size cells";
+                    agentSize = *value;
+                } else if (token == "maxcost") {
+                    auto const value = toNumber<double>(nextToken(query));
+                    if (!value)
+                        return "error expected maxcost cost";
+                    limits.maxCost = gr::Distance { *value };
+                } else if (token == "maxexp") {
+                    auto const value = toNumber<std::size_t>(nextToken(query));
+                    if (!value)
+                        return "error expected maxexp count";
+                    limits.maxExpansions = *value;
+                } else if (token == "timeout") {
+                    auto const value = toNumber<std::size_t>(nextToken(query));
+                    if (!value)
+                        return "error expected timeout milliseconds";
+                    limits.deadline = received + std::chrono::milliseconds { *value };
+                } else {
+                    return "error unknown option " + std::string { token };
+                }
+            }
+
+            // Edits published from now on do not affect this query
+            current = map.snapshot();
+            auto const source = idOf(coords[0], coords[1]);
+            auto const target = idOf(coords[2], coords[3]);
+            if (!source || !target)
+                return "error cell out of the map or an obstacle";
+            view.emplace(*current, agentSize);
+            if (!view->fits(*source) || !view->fits(*target))
+                return "error no room for the agent at an endpoint";
+
+            // Every option but the deadline, which only decides whether
+            // there is a result at all
+            std::string options { withPath ? "path" : "" };
+            if (agentSize != 1)
+                options += " size " + std::to_string(agentSize);
+            if (limits.maxCost) {
+                options += " maxcost ";
+                append(options, limits.maxCost->value());
+            }
+            if (limits.maxExpansions)
+                options += " maxexp " + std::to_string(*limits.maxExpansions);
+            typename PathCache<std::string>::Key key { current->version(), *source, *target, std::move(options) };
+            if (auto const hit = cache.find(key))
+                return *hit;
+
+            auto result = solve(*source, *target, limits, withPath);
+            // How far a search gets before its deadline depends on the load
+            if (djk.status() != SearchStatus::DEADLINE)
+                cache.insert(std::move(key), std::make_shared<std::string const>(result));
+            return result;
+        }
+
+        std::string solve(typename Snapshot::VertexId source, typename Snapshot::VertexId target, SearchLimits<gr::Distance> const& limits, bool withPath)
+        {
+            djk.loadGraph(*view, source, target);
+            djk.setLimits(limits);
+            djk.run();
+            std::string result {};
+            if (auto const reason = cutoff(djk.status())) {
+                result = "cutoff ";
+                result += reason;
+                result += ' ';
+                result += std::to_string(djk.expansions());
+                result += ' ';
+                append(result, djk.bound().value());
+                // The best the search got to, see SearchStatus
+                auto const nearest = djk.nearest();
+                result += ' ';
+                append(result, djk.distance(nearest).value());
+                if (withPath)
+                    appendPath(result, djk.path(nearest));
+                return result;
+            }
+            auto const cost = djk.cost();
+            if (!cost) {
+                result = "none ";
+                result += std::to_string(djk.expansions());
+                return result;
+            }
+            append(result, cost->value());
+            result += ' ';
+            result += std::to_string(djk.expansions());
+            if (withPath)
+                appendPath(result, djk.path());
+            return result;
+        }
+
+        void appendPath(std::string& result, std::vector<typename Snapshot::VertexId> const& path) const
+        {
+            for (auto v : path) {
+                result += ' ';
+                result += std::to_string(v / current->cols());
+                result += ',';
+                result += std::to_string(v % current->cols());
+            }
+        }
+
+        std::optional<typename Snapshot::VertexId> idOf(int row, int col) const
+        {
+            if (row < 0 || col < 0
+                || static_cast<std::size_t>(row) >= current->rows()
+                || static_cast<std::size_t>(col) >= current->cols())
+                return std::nullopt;
+            auto const id = static_cast<typename Snapshot::VertexId>(row) * current->cols() + static_cast<std::size_t>(col);
+            if (current->type(id) == gr::pointObstacle)
+                return std::nullopt;
+            return id;
+        }
+
+        gr::VersionedMap<C>& map;
+        PathCache<std::string>& cache;
+        // Kept alive for as long as the solver refers to them
+        std::shared_ptr<Snapshot const> current {};
+        std::optional<gr::AgentView<Snapshot>> view {};
+        BasicDijkstra<gr::AgentView<Snapshot> const, SetOpenList<gr::Distance, typename Snapshot::VertexId>, Heuristic> djk {};
+    };
+
+public:
+    BasicQueryServer(gr::MapData const& map_, std::size_t cacheSize)
+        : map { map_ }
+        , cache { cacheSize }
+    {
+    }
+
+    std::unique_ptr<Session> session() override { return std::make_unique<BasicSession>(map, cache); }
+
+private:
+    gr::VersionedMap<C> map;
+    // Answers, shared by all the sessions
+    PathCache<std::string> cache;
+};
+
+#if SERVER_HAS_SOCKETS
+bool writeAll(int fd, std::string_view data)
+{
+    while (!data.empty()) {
+        auto const written = ::write(fd, data.data(), data.size());
+        if (written <= 0)
+            return false;
+        data.remove_prefix(static_cast<std::size_t>(written));
+    }
+    return true;
+}
+
+void serveClient(QueryServer::Session& session, int client)
+{
+    std::string pending {};
+    char buffer[1 << 16];
+    for (;;) {
+        auto const count = ::read(client, buffer, sizeof(buffer));
+        if (count <= 0)
+            break;
+        pending.append(buffer, static_cast<std::size_t>(count));
+        // Every complete line is answered at once, in a single write
+        std::string answers {};
+        std::size_t begin {};
+        for (auto end = pending.find('\n'); end != std::string::npos; end = pending.find('\n', begin)) {
+            answers += session.answer(std::string_view { pending }.substr(begin, end - begin));
+            answers += '\n';
+            begin = end + 1;
+        }
+        pending.erase(0, begin);
+        if (!writeAll(client, answers))
+            return;
+    }
+    if (!pending.empty())
+        writeAll(client, session.answer(pending) + '\n');
+}
+#endif
+}
+
+std::unique_ptr<QueryServer> QueryServer::make(gr::MapData const& map, gr::ConnectivityMode mode, std::size_t cacheSize)
+{
+    switch (mode) {
+    case gr::ConnectivityMode::FOUR:
+        return std::make_unique<BasicQueryServer<gr::FourConnected>>(map, cacheSize);
+    case gr::ConnectivityMode::CORNER_CUTTING:
+        return std::make_unique<BasicQueryServer<gr::CornerCutting>>(map, cacheSize);
+    case gr::ConnectivityMode::EIGHT:
+        break;
+    }
+    return std::make_unique<BasicQueryServer<gr::EightConnected>>(map, cacheSize);
+}
+
+void QueryServer::serve(std::istream& in, std::ostream& out)
+{
+    auto const s = session();
+    std::string line {};
+    while (std::getline(in, line)) {
+        out << s->answer(line) << '\n';
+        // Batched while more queries are already waiting
+        if (in.rdbuf()->in_avail() <= 0)
+            out.flush();
+    }
+    out.flush();
+}
+
+#if SERVER_HAS_SOCKETS
+void QueryServer::listen(std::string_view socketPath)
+{
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path))
+        throw ServerException {};
+    std::memcpy(address.sun_path, socketPath.data(), socketPath.size());
+
+    int const fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        throw ServerException {};
+    // A socket left behind by a previous run would make bind fail
+    ::unlink(address.sun_path);
+    if (::bind(fd, reinterpret_cast<sockaddr const*>(&address), sizeof(address)) != 0
+        || ::listen(fd, 16) != 0) {
+        ::close(fd);
+        throw ServerException {};
+    }
+    // A client leaving early must not take the server down with it
+    std::signal(SIGPIPE, SIG_IGN);
+    for (;;) {
+        int const client = ::accept(fd, nullptr, nullptr);
+        if (client < 0)
+            continue;
+        // Each client searches on its own thread, edits from one of them
+        // are seen by the queries the others start afterwards
+        std::thread { [this, client] {
+            serveClient(*session(), client);
+            ::close(client);
+        } }.detach();
+    }
+}
+#else
+void QueryServer::listen(std::string_view)
+{
+    throw ServerException {};
+}
+#endif
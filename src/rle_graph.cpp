@@ -0,0 +1,102 @@
+#include "rle_graph.hpp"
+#include "io.hpp"
+#include <algorithm>
+#include <string_view>
+
+namespace gr {
+
+RunRows RunRows::fromFile(std::string_view fname)
+{
+    RunRows result {};
+    for (auto line : io::File { fname, io::in })
+        result.addRow(line);
+    result.shrink();
+    return result;
+}
+
+RunRows RunRows::fromMap(MapData const& map)
+{
+    RunRows result {};
+    for (std::size_t r = 0; r < map.rowCount(); ++r)
+        result.addRow({ reinterpret_cast<char const*>(map.cells.data() + map.rowStart[r]), map.rowStart[r + 1] - map.rowStart[r] });
+    result.shrink();
+    return result;
+}
+
+void RunRows::addRow(std::string_view line)
+{
+    constexpr char cellTypes[] { static_cast<char>(pointEmpty), static_cast<char>(pointObstacle),
+        static_cast<char>(pointStart), static_cast<char>(pointEnd), '\0' };
+    constexpr auto obstacle = static_cast<char>(pointObstacle);
+    if (line.find_first_not_of(cellTypes) != std::string_view::npos)
+        throw InvalidGraphException {};
+
+    auto const r = rowCount();
+    for (auto p = line.find(static_cast<char>(pointStart)); p != std::string_view::npos; p = line.find(static_cast<char>(pointStart), p + 1)) {
+        if (start)
+            throw InvalidGraphException {};
+        start = Cell { r, p };
+    }
+    for (auto p = line.find(static_cast<char>(pointEnd)); p != std::string_view::npos; p = line.find(static_cast<char>(pointEnd), p + 1))
+        ends.push_back({ r, p });
+
+    auto const first = runs.size();
+    for (auto begin = line.find(obstacle); begin != std::string_view::npos;) {
+        auto end = line.find_first_not_of(obstacle, begin);
+        if (end == std::string_view::npos)
+            end = line.size();
+        runs.push_back({ static_cast<std::uint32_t>(begin), static_cast<std::uint32_t>(end) });
+        begin = line.find(obstacle, end);
+    }
+    if (runs.size() != first && runs.back().end == line.size())
+        runs.back().end = rowEnd;
+    else
+        runs.push_back({ static_cast<std::uint32_t>(line.size()), rowEnd });
+    rowRun.push_back(runs.size());
+    cols = std::max(cols, line.size());
+}
+
+void RunRows::shrink()
+{
+    runs.shrink_to_fit();
+    rowRun.shrink_to_fit();
+    ends.shrink_to_fit();
+}
+
+bool RunRows::isFree(std::int64_t r, std::int64_t col) const
+{
+    if (r < 0 || col < 0 || static_cast<std::size_t>(r) >= rowCount())
+        return false;
+    auto const line = row(static_cast<std::size_t>(r));
+    auto const c = static_cast<std::uint64_t>(col);
+    // The first run that ends past the cell, if any, is the only one that
+    // can hold it
+    auto const it = std::ranges::partition_point(line, [&](Run const& run) { return run.end <= c; });
+    return it == line.end() || c < it->begin;
+}
+
+std::uint16_t RunRows::around(std::int64_t r, std::int64_t col) const
+{
+    std::uint16_t result {};
+    auto const lo = static_cast<std::uint64_t>(std::max<std::int64_t>(col - 1, 0));
+    auto const hi = static_cast<std::uint64_t>(col + 1);
+    for (int dx = -1; dx <= 1; ++dx) {
+        if (r + dx < 0 || static_cast<std::size_t>(r + dx) >= rowCount())
+            continue;
+        // Columns col - 1, col and col + 1, free until a run covers them
+        unsigned bits { col == 0 ? 0b110u : 0b111u };
+        auto const line = row(static_cast<std::size_t>(r + dx));
+        for (auto it = std::ranges::partition_point(line, [&](Run const& run) { return run.end <= lo; });
+             it != line.end() && it->begin <= hi; ++it) {
+            for (std::uint64_t k = 0; k < 3; ++k) {
+                auto const c = static_cast<std::uint64_t>(col) + k - 1;
+                if (k + static_cast<std::uint64_t>(col) >= 1 && c >= it->begin && c < it->end)
+                    bits &= ~(1u << k);
+            }
+        }
+        result |= static_cast<std::uint16_t>(bits << ((dx + 1) * 3));
+    }
+    return result;
+}
+
+}
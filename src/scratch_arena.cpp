@@ -0,0 +1,38 @@
+#include "scratch_arena.hpp"
+#include <algorithm>
+
+ScratchArena::ScratchArena()
+{
+    arena.emplace();
+}
+
+void ScratchArena::rewind()
+{
+    if (tracking.used > bytes) {
+        // Room for the alignment padding and some growth
+        bytes = std::max(tracking.used + tracking.used / 4, 2 * bytes);
+        arena.reset();
+        buffer = std::make_unique<std::byte[]>(bytes);
+    }
+    tracking.used = 0;
+    if (bytes == 0)
+        arena.emplace();
+    else
+        arena.emplace(buffer.get(), bytes);
+}
+
+void* ScratchArena::Tracking::do_allocate(std::size_t size, std::size_t alignment)
+{
+    used += size;
+    return owner.arena->allocate(size, alignment);
+}
+
+void ScratchArena::Tracking::do_deallocate(void* p, std::size_t size, std::size_t alignment)
+{
+    owner.arena->deallocate(p, size, alignment);
+}
+
+bool ScratchArena::Tracking::do_is_equal(std::pmr::memory_resource const& other) const noexcept
+{
+    return this == &other;
+}
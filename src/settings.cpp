@@ -1,34 +1,14 @@
 #include "settings.hpp"
 #include "config_parser.hpp"
 #include "graph.hpp"
-#include "io.hpp"
-#include <iostream>
+#include "map_loader.hpp"
 #include <string>
-
-namespace {
-CellsNumber getCells(std::string_view str)
-{
-    std::size_t maxCount {};
-    std::size_t counter {};
-    std::size_t lines {};
-    for (char ch : str) {
-        if (ch != '\n') {
-            counter += 1;
-        } else {
-            lines += 1;
-            if (maxCount < counter)
-                maxCount = counter;
-            counter = 0;
-        }
-    }
-    return { .x = maxCount, .y = lines };
-}
-}
+#include <utility>
 
 Settings getSettings(int argc, char** argv)
 {
     ConfigParser config {};
-    std::variant<Grid, std::string> grid;
+    std::variant<Grid, MapFile> grid;
     CellsNumber cellsNumber;
     if (argc == 2 && std::string_view { argv[1] } == "-i") {
         config.parse("../text_files/config_i.txt");
@@ -40,13 +20,12 @@ Settings getSettings(int argc, char** argv)
         cellsNumber.y = static_cast<decltype(WindowSize::height)>(std::get<0>(grid).rows);
     } else {
         config.parse("../text_files/config.txt");
-        try {
-            grid = std::string { config.get("graphPath") };
-            cellsNumber = getCells(io::File { config.get("graphPath") }.read());
-        } catch (gr::InvalidGraphException const& e) {
-            std::cerr << e.what() << '\n';
-            throw;
-        }
+        // A guess that costs the same for any map, so that the window shows
+        // up at once. The App fits it to the rows as they are read
+        std::string path { config.get("graphPath") };
+        auto const shape = gr::peekMapShape(path);
+        grid = MapFile { .path = std::move(path), .shape = shape };
+        cellsNumber = { .x = shape.cols, .y = shape.rows };
     }
     CellSize const cellSize {
         .width = std::stoul(config.get("edgeWidth").data()),
@@ -59,6 +38,7 @@ Settings getSettings(int argc, char** argv)
             static_cast<decltype(WindowSize::width)>(cellsNumber.x * cellSize.width),
             static_cast<decltype(WindowSize::height)>(cellsNumber.y * cellSize.height) },
         .grid = std::move(grid),
-        .timeStep = std::atoi(config.get("maxFrameRate").data())
+        .timeStep = std::atoi(config.get("maxFrameRate").data()),
+        .connectivity = gr::parseConnectivity(config.get("connectivity"))
     };
 }
\ No newline at end of file
@@ -0,0 +1,148 @@
+#include "tiled_graph.hpp"
+#include "io.hpp"
+#include <algorithm>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <utility>
+
+namespace gr {
+
+namespace {
+    std::uint64_t tileBytes(TiledHeader const& head)
+    {
+        return head.tileSize * head.tileSize;
+    }
+
+    std::uint64_t tilesAlong(std::uint64_t cells, std::uint64_t tileSize)
+    {
+        return (cells + tileSize - 1) / tileSize;
+    }
+}
+
+void writeTiled(std::string_view asciiMap, std::string_view tiledMap, std::size_t tileSize)
+{
+    if (tileSize == 0)
+        throw InvalidTiledMapException {};
+
+    // First pass: size and endpoints, with the same checks as loadMap. The
+    // header has room for a single end, so a repeated one is rejected too
+    TiledHeader head {};
+    head.tileSize = tileSize;
+    std::optional<std::pair<std::uint64_t, std::uint64_t>> start {};
+    std::optional<std::pair<std::uint64_t, std::uint64_t>> end {};
+    for (auto line : io::File { asciiMap, io::in }) {
+        for (std::uint64_t col = 0; col < line.size(); ++col) {
+            switch (static_cast<CharType>(line[col])) {
+            case pointStart:
+                if (start)
+                    throw InvalidGraphException {};
+                start = { head.rows, col };
+                break;
+            case pointEnd:
+                if (end)
+                    throw InvalidGraphException {};
+                end = { head.rows, col };
+                break;
+            case pointEmpty:
+            case pointObstacle:
+                break;
+            default:
+                throw InvalidGraphException {};
+            }
+        }
+        head.cols = std::max<std::uint64_t>(head.cols, line.size());
+        head.rows += 1;
+    }
+    if (start)
+        head.start = start->first * head.cols + start->second;
+    if (end)
+        head.end = end->first * head.cols + end->second;
+
+    TiledWriter out { tiledMap, head };
+    // Second pass: the cells
+    for (auto line : io::File { asciiMap, io::in })
+        out.addRow(line);
+    out.finish();
+}
+
+TiledWriter::TiledWriter(std::string_view fname, TiledHeader const& head)
+    : out { fname, io::out | io::bin }
+    , tileSize { head.tileSize }
+{
+    if (tileSize == 0)
+        throw InvalidTiledMapException {};
+    band.assign(tileSize * tilesAlong(head.cols, tileSize) * tileSize, 0);
+    out.write({ reinterpret_cast<char const*>(&head), sizeof(head) });
+}
+
+void TiledWriter::addRow(std::string_view line)
+{
+    auto const r = rows % tileSize;
+    auto const width = std::min<std::uint64_t>(line.size(), band.size() / tileSize);
+    for (std::uint64_t col = 0; col < width; ++col) {
+        auto const tile = col / tileSize;
+        band[(tile * tileSize + r) * tileSize + col % tileSize] = static_cast<CharType>(line[col]) != pointObstacle;
+    }
+    rows += 1;
+    if (rows % tileSize == 0)
+        flush();
+}
+
+void TiledWriter::finish()
+{
+    if (rows % tileSize != 0)
+        flush();
+}
+
+void TiledWriter::flush()
+{
+    // One band of tileSize rows at a time
+    out.write({ band.data(), band.size() });
+    std::ranges::fill(band, 0);
+}
+
+TileStore::TileStore(std::string_view fname, std::size_t maxResident_)
+    : maxResident { std::max<std::size_t>(maxResident_, 1) }
+    , file { fname, io::in | io::bin }
+{
+    file.read(reinterpret_cast<char*>(&head), sizeof(head));
+    if (std::memcmp(head.magic, TiledHeader {}.magic, sizeof(head.magic)) != 0 || head.tileSize == 0)
+        throw InvalidTiledMapException {};
+    tilesPerRow = tilesAlong(head.cols, head.tileSize);
+}
+
+unsigned char const* TileStore::tile(std::uint64_t key) const
+{
+    if (auto it = resident.find(key); it != resident.end()) {
+        uses.splice(uses.begin(), uses, it->second.use);
+        return it->second.cells.data();
+    }
+
+    if (resident.size() < maxResident) {
+        uses.push_front(key);
+        auto& entry = resident[key];
+        entry.cells.resize(tileBytes(head));
+        entry.use = uses.begin();
+        return load(key, entry);
+    }
+
+    // Evict the least recently used tile, reusing its map node, list node
+    // and buffer so that a full store loads tiles without allocating
+    auto node = resident.extract(uses.back());
+    node.key() = key;
+    uses.splice(uses.begin(), uses, node.mapped().use);
+    uses.front() = key;
+    auto& entry = resident.insert(std::move(node)).position->second;
+    return load(key, entry);
+}
+
+unsigned char const* TileStore::load(std::uint64_t key, Resident& entry) const
+{
+    file.seek(static_cast<std::streamoff>(sizeof(head) + key * tileBytes(head)));
+    file.read(reinterpret_cast<char*>(entry.cells.data()), entry.cells.size());
+    loads += 1;
+    return entry.cells.data();
+}
+
+}
@@ -0,0 +1,410 @@
+// Generates a map for benchmarks and scale tests. The same seed always gives
+// the same map. Rows are produced one at a time, so the size of the map is
+// only bounded by the disk.
+// Usage: dijkstra_generate [-s seed] [-d density] [-t tileSize] type rows cols output
+// type is one of
+//     random  obstacles scattered with probability density
+//     walls   long straight walls like the example level, density being the
+//             probability of a wall per 32x32 block
+//     rooms   rooms joined by corridors
+//     maze    a perfect maze, with corridors one cell wide
+// The output is a tiled map when its name ends in .tiles, an ASCII map
+// otherwise. A is placed near the top left corner and B near the bottom
+// right one.
+#include "graph.hpp"
+#include "io.hpp"
+#include "tiled_graph.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Stateless hash of a seed and two coordinates (splitmix64 finaliser), so
+// that any cell can be generated without the ones before it
+std::uint64_t mix(std::uint64_t seed, std::uint64_t a, std::uint64_t b)
+{
+    std::uint64_t z = seed + a * 0x9e3779b97f4a7c15ull + b * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+struct Cell {
+    std::size_t row {};
+    std::size_t col {};
+};
+
+// Fills the rows of a map in order, from 0 to rows - 1
+class Generator {
+public:
+    virtual ~Generator() = default;
+    virtual void fill(std::size_t row, std::string& line) = 0;
+    [[nodiscard]] virtual Cell start() const = 0;
+    [[nodiscard]] virtual Cell end() const = 0;
+};
+
+class RandomGenerator : public Generator {
+public:
+    RandomGenerator(std::uint64_t seed_, double density, std::size_t rows_, std::size_t cols_)
+        : seed { seed_ }
+        , threshold { density >= 1. ? ~std::uint64_t {} : static_cast<std::uint64_t>(std::max(density, 0.) * 18446744073709551616.) }
+        , rows { rows_ }
+        , cols { cols_ }
+    {
+    }
+
+    void fill(std::size_t row, std::string& line) override
+    {
+        for (std::size_t col = 0; col < cols; ++col)
+            line[col] = static_cast<char>(mix(seed, row, col) < threshold ? gr::pointObstacle : gr::pointEmpty);
+    }
+    Cell start() const override { return { 0, 0 }; }
+    Cell end() const override { return { rows - 1, cols - 1 }; }
+
+private:
+    std::uint64_t seed {};
+    std::uint64_t threshold {};
+    std::size_t rows {};
+    std::size_t cols {};
+};
+
+// Each block may hold one horizontal and one vertical wall, kept inside it
+class WallsGenerator : public Generator {
+public:
+    WallsGenerator(std::uint64_t seed_, double density_, std::size_t rows_, std::size_t cols_)
+        : seed { seed_ }
+        , density { std::clamp(density_, 0., 1.) }
+        , rows { rows_ }
+        , cols { cols_ }
+    {
+    }
+
+    void fill(std::size_t row, std::string& line) override
+    {
+        std::ranges::fill(line, static_cast<char>(gr::pointEmpty));
+        for (std::size_t bc = 0; bc * block < cols; ++bc) {
+            auto const h = wall(row / block, bc, 0);
+            if (h.present && row % block == h.offset)
+                for (auto c = h.from; c < h.from + h.length && bc * block + c < cols; ++c)
+                    line[bc * block + c] = static_cast<char>(gr::pointObstacle);
+            auto const v = wall(row / block, bc, 1);
+            if (v.present && row % block >= v.from && row % block < v.from + v.length && bc * block + v.offset < cols)
+                line[bc * block + v.offset] = static_cast<char>(gr::pointObstacle);
+        }
+    }
+    Cell start() const override { return { 0, 0 }; }
+    Cell end() const override { return { rows - 1, cols - 1 }; }
+
+private:
+    static constexpr std::size_t block { 32 };
+
+    struct Wall {
+        bool present {};
+        // Row of a horizontal wall in its block, column of a vertical one
+        std::size_t offset {};
+        std::size_t from {};
+        std::size_t length {};
+    };
+
+    Wall wall(std::size_t br, std::size_t bc, std::uint64_t vertical) const
+    {
+        auto const h = mix(seed ^ (vertical + 1), br, bc);
+        Wall w {};
+        w.present = static_cast<double>(h & 0xffff) < density * 65536.;
+        w.offset = (h >> 16) % block;
+        w.length = block / 2 + (h >> 24) % (block / 2);
+        w.from = (h >> 32) % (block - w.length + 1);
+        return w;
+    }
+
+    std::uint64_t seed {};
+    double density {};
+    std::size_t rows {};
+    std::size_t cols {};
+};
+
+// One room per block, holding the centre of the block. Corridors run along
+// the centre row and column of the blocks, joining every room to its right
+// and lower neighbours
+class RoomsGenerator : public Generator {
+public:
+    RoomsGenerator(std::uint64_t seed_, std::size_t rows_, std::size_t cols_)
+        : seed { seed_ }
+        , rows { rows_ }
+        , cols { cols_ }
+    {
+    }
+
+    void fill(std::size_t row, std::string& line) override
+    {
+        auto const br = row / block;
+        auto const r = row % block;
+        Room room {};
+        for (std::size_t col = 0; col < cols; ++col) {
+            auto const bc = col / block;
+            auto const c = col % block;
+            if (c == 0)
+                room = roomOf(br, bc);
+            bool free = r >= room.top && r < room.bottom && c >= room.left && c < room.right;
+            // Towards the right neighbour, and towards the lower one
+            free = free || (r == centre && c >= centre && (bc + 1) * block < cols);
+            free = free || (c == centre && r >= centre && (br + 1) * block < rows);
+            // From the left and the upper neighbours
+            free = free || (r == centre && c <= centre && bc > 0);
+            free = free || (c == centre && r <= centre && br > 0);
+            line[col] = static_cast<char>(free ? gr::pointEmpty : gr::pointObstacle);
+        }
+    }
+    Cell start() const override { return centreOf(0, 0); }
+    // The last block whose centre is on the map
+    Cell end() const override
+    {
+        return centreOf(rows > centre ? (rows - 1 - centre) / block : 0, cols > centre ? (cols - 1 - centre) / block : 0);
+    }
+
+private:
+    static constexpr std::size_t block { 16 };
+    static constexpr std::size_t centre { block / 2 };
+
+    struct Room {
+        std::size_t top {};
+        std::size_t bottom {};
+        std::size_t left {};
+        std::size_t right {};
+    };
+
+    Room roomOf(std::size_t br, std::size_t bc) const
+    {
+        // A wall of at least one cell between the rooms of neighbouring blocks
+        auto const h = mix(seed, br, bc);
+        auto const extent = [&](int shift) { return 1 + (h >> shift) % (centre - 1); };
+        return { centre - extent(0), centre + extent(8), centre - extent(16), centre + extent(24) };
+    }
+
+    // Clamped to the map when its last block is cut short
+    Cell centreOf(std::size_t br, std::size_t bc) const
+    {
+        return { std::min(br * block + centre, rows - 1), std::min(bc * block + centre, cols - 1) };
+    }
+
+    std::uint64_t seed {};
+    std::size_t rows {};
+    std::size_t cols {};
+};
+
+// Eller's algorithm: a perfect maze built one row of maze cells at a time,
+// with memory linear in the width. Maze cell (i, j) is map cell
+// (2i + 1, 2j + 1), the cells in between are walls or passages.
+class MazeGenerator : public Generator {
+public:
+    MazeGenerator(std::uint64_t seed, std::size_t rows_, std::size_t cols_)
+        : rng { seed }
+        , rows { rows_ }
+        , cols { cols_ }
+        , height { (rows_ - 1) / 2 }
+        , width { (cols_ - 1) / 2 }
+        , parent(width)
+        , right(width)
+        , down(width)
+        , carried(width)
+        , roots(width)
+    {
+        std::iota(parent.begin(), parent.end(), std::size_t { 0 });
+    }
+
+    void fill(std::size_t row, std::string& line) override
+    {
+        std::ranges::fill(line, static_cast<char>(gr::pointObstacle));
+        auto const i = (row - 1) / 2;
+        if (row == 0 || i >= height)
+            return;
+        if (row % 2 == 1) {
+            nextRow(i);
+            for (std::size_t j = 0; j < width; ++j) {
+                line[2 * j + 1] = static_cast<char>(gr::pointEmpty);
+                if (right[j])
+                    line[2 * j + 2] = static_cast<char>(gr::pointEmpty);
+            }
+        } else {
+            for (std::size_t j = 0; j < width; ++j)
+                if (down[j])
+                    line[2 * j + 1] = static_cast<char>(gr::pointEmpty);
+        }
+    }
+    Cell start() const override { return { 1, 1 }; }
+    Cell end() const override { return { 2 * height - 1, 2 * width - 1 }; }
+
+private:
+    std::size_t find(std::size_t j)
+    {
+        while (parent[j] != j)
+            j = parent[j] = parent[parent[j]];
+        return j;
+    }
+
+    // Sets of the cells of row i, from the passages down of row i - 1
+    void nextRow(std::size_t i)
+    {
+        if (i > 0) {
+            // Cells reached from above stay in the set of the cell above them
+            std::ranges::fill(carried, width);
+            for (std::size_t j = 0; j < width; ++j) {
+                roots[j] = find(j);
+                if (down[j] && carried[roots[j]] == width)
+                    carried[roots[j]] = j;
+            }
+            for (std::size_t j = 0; j < width; ++j)
+                parent[j] = down[j] ? carried[roots[j]] : j;
+        }
+
+        bool const last = i + 1 == height;
+        std::bernoulli_distribution coin { 0.5 };
+        for (std::size_t j = 0; j + 1 < width; ++j) {
+            auto const a = find(j);
+            auto const b = find(j + 1);
+            right[j] = a != b && (last || coin(rng));
+            if (right[j])
+                parent[b] = a;
+        }
+        if (width > 0)
+            right[width - 1] = false;
+
+        std::fill(down.begin(), down.end(), false);
+        if (last)
+            return;
+        // Every set goes down at least once, through its last cell if the
+        // coin never chose one
+        std::ranges::fill(carried, width);
+        for (std::size_t j = 0; j < width; ++j) {
+            down[j] = coin(rng);
+            if (down[j])
+                carried[find(j)] = j;
+        }
+        for (std::size_t j = width; j-- > 0;) {
+            auto const root = find(j);
+            if (carried[root] == width) {
+                down[j] = true;
+                carried[root] = j;
+            }
+        }
+    }
+
+    std::mt19937_64 rng;
+    std::size_t rows {};
+    std::size_t cols {};
+    std::size_t height {};
+    std::size_t width {};
+    // Union-find over the maze cells of the current row
+    std::vector<std::size_t> parent {};
+    std::vector<bool> right {};
+    std::vector<bool> down {};
+    // Per set: a cell of it with a passage down, width if none yet
+    std::vector<std::size_t> carried {};
+    std::vector<std::size_t> roots {};
+};
+
+std::unique_ptr<Generator> makeGenerator(std::string_view type, std::uint64_t seed, double density, std::size_t rows, std::size_t cols)
+{
+    if (type == "random")
+        return std::make_unique<RandomGenerator>(seed, density, rows, cols);
+    if (type == "walls")
+        return std::make_unique<WallsGenerator>(seed, density, rows, cols);
+    if (type == "rooms")
+        return std::make_unique<RoomsGenerator>(seed, rows, cols);
+    if (type == "maze" && rows >= 3 && cols >= 3)
+        return std::make_unique<MazeGenerator>(seed, rows, cols);
+    return nullptr;
+}
+
+// Endpoints are written over whatever the generator put there
+void placeEndpoints(std::size_t row, std::string& line, Cell const& start, Cell const& end)
+{
+    if (row == start.row)
+        line[start.col] = static_cast<char>(gr::pointStart);
+    if (row == end.row)
+        line[end.col] = static_cast<char>(gr::pointEnd);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    std::uint64_t seed { 1 };
+    double density { 0.2 };
+    std::size_t tileSize { 256 };
+    std::vector<std::string_view> args {};
+    try {
+        for (int i = 1; i < argc; ++i) {
+            if (std::string_view { argv[i] } == "-s" && i + 1 < argc)
+                seed = std::stoull(argv[++i]);
+            else if (std::string_view { argv[i] } == "-d" && i + 1 < argc)
+                density = std::stod(argv[++i]);
+            else if (std::string_view { argv[i] } == "-t" && i + 1 < argc)
+                tileSize = std::stoul(argv[++i]);
+            else
+                args.emplace_back(argv[i]);
+        }
+        std::size_t const rows = args.size() == 4 ? std::stoul(std::string { args[1] }) : 0;
+        std::size_t const cols = args.size() == 4 ? std::stoul(std::string { args[2] }) : 0;
+        auto generator = rows > 0 && cols > 0 ? makeGenerator(args[0], seed, density, rows, cols) : nullptr;
+        if (!generator) {
+            std::cerr << "Usage: " << argv[0] << " [-s seed] [-d density] [-t tileSize] random|walls|rooms|maze rows cols output\n";
+            return 1;
+        }
+        auto const start = generator->start();
+        auto const end = generator->end();
+        std::string line(cols, static_cast<char>(gr::pointEmpty));
+
+        if (args[3].ends_with(".tiles")) {
+            gr::TiledHeader head {};
+            head.rows = rows;
+            head.cols = cols;
+            head.tileSize = tileSize;
+            head.start = start.row * cols + start.col;
+            head.end = end.row * cols + end.col;
+            gr::TiledWriter out { args[3], head };
+            for (std::size_t row = 0; row < rows; ++row) {
+                generator->fill(row, line);
+                placeEndpoints(row, line, start, end);
+                out.addRow(line);
+            }
+            out.finish();
+            return 0;
+        }
+
+        io::File out { args[3], io::out | io::bin };
+        // Written in batches of rows rather than one row at a time
+        constexpr std::size_t batchBytes { std::size_t { 1 } << 20 };
+        std::string batch {};
+        batch.reserve(batchBytes + cols + 1);
+        for (std::size_t row = 0; row < rows; ++row) {
+            generator->fill(row, line);
+            placeEndpoints(row, line, start, end);
+            batch += line;
+            batch += '\n';
+            if (batch.size() >= batchBytes) {
+                out.write(batch);
+                batch.clear();
+            }
+        }
+        out.write(batch);
+    } catch (std::logic_error const& e) {
+        std::cerr << "Invalid number: " << e.what() << '\n';
+        return 1;
+    } catch (gr::InvalidTiledMapException const& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    } catch (io::FileException const& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+}
@@ -0,0 +1,59 @@
+// Loads a map once and answers path queries, one per line, read from stdin
+// or from the clients of a Unix domain socket. See QueryServer for the
+// protocol.
+// Usage: dijkstra_server [-c 4|8|8-cut] [-s socket] [-k cacheSize] map.txt
+#include "graph.hpp"
+#include "io.hpp"
+#include "query_server.hpp"
+#include <iostream>
+#include <cstddef>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+int main(int argc, char** argv)
+{
+    auto mode { gr::ConnectivityMode::EIGHT };
+    std::optional<std::string> socketPath {};
+    std::optional<std::string> map {};
+    std::size_t cacheSize { 1024 };
+    try {
+        for (int i = 1; i < argc; ++i) {
+            if (std::string_view { argv[i] } == "-c" && i + 1 < argc)
+                mode = gr::parseConnectivity(argv[++i]);
+            else if (std::string_view { argv[i] } == "-s" && i + 1 < argc)
+                socketPath = argv[++i];
+            else if (std::string_view { argv[i] } == "-k" && i + 1 < argc)
+                cacheSize = std::stoul(argv[++i]);
+            else
+                map = argv[i];
+        }
+        if (!map) {
+            std::cerr << "Usage: " << argv[0] << " [-c 4|8|8-cut] [-s socket] [-k cacheSize] map.txt\n";
+            return 1;
+        }
+
+        auto const server = QueryServer::make(gr::loadMap(*map), mode, cacheSize);
+        std::ios::sync_with_stdio(false);
+        if (socketPath)
+            server->listen(*socketPath);
+        else
+            server->serve(std::cin, std::cout);
+    } catch (gr::InvalidConnectivityException const& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    } catch (gr::InvalidGraphException const& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    } catch (io::FileException const& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    } catch (std::logic_error const& e) {
+        std::cerr << "Invalid number: " << e.what() << '\n';
+        return 1;
+    } catch (ServerException const& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+}
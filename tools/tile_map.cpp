@@ -0,0 +1,24 @@
+// Converts an ASCII map to the tiled format read by gr::TiledGraph.
+// Usage: dijkstra_tile input.txt output.tiles [tileSize]
+#include "graph.hpp"
+#include "io.hpp"
+#include "tiled_graph.hpp"
+#include <iostream>
+#include <string>
+
+int main(int argc, char** argv)
+{
+    if (argc != 3 && argc != 4) {
+        std::cerr << "Usage: " << argv[0] << " input.txt output.tiles [tileSize]\n";
+        return 1;
+    }
+    try {
+        gr::writeTiled(argv[1], argv[2], argc == 4 ? std::stoul(argv[3]) : 256);
+    } catch (gr::InvalidGraphException const& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    } catch (io::FileException const& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+}